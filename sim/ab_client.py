@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+"""Small client for ab_service: opens sessions, plays the same shots in all of them
+and prints the results. Every session has one request in flight at a time so the
+sessions run in parallel on the service's workers."""
+
+import argparse
+import socket
+import sys
+import time
+
+
+def parse_shot(text):
+    parts = text.split(":")
+    if len(parts) not in (2, 3):
+        raise argparse.ArgumentTypeError("expected DIRECTION:POWER[:ABILITY_STEP]")
+    ability = int(parts[2]) if len(parts) == 3 else -1
+    return float(parts[0]), float(parts[1]), ability
+
+
+def session_script(name, level, shots):
+    yield "open " + name
+    yield "load %s %s" % (name, level)
+    for direction, power, ability in shots:
+        yield "throw %s %g %g" % (name, direction, power)
+        if ability >= 0:
+            yield "step %s %d" % (name, ability)
+            yield "ability " + name
+        yield "settle " + name
+    yield "snapshot " + name
+    yield "close " + name
+
+
+class Client:
+    def __init__(self, path):
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.connect(path)
+        self.buffer = b""
+
+    def send(self, line):
+        self.sock.sendall(line.encode() + b"\n")
+
+    def read_line(self):
+        while b"\n" not in self.buffer:
+            chunk = self.sock.recv(65536)
+            if not chunk:
+                raise ConnectionError("service closed the connection")
+            self.buffer += chunk
+        line, self.buffer = self.buffer.split(b"\n", 1)
+        return line.decode()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("level", help="level file, relative to where the service runs")
+    parser.add_argument("--socket", default="ab_service.sock")
+    parser.add_argument("--sessions", type=int, default=1)
+    parser.add_argument("--shot", type=parse_shot, action="append",
+                        help="DIRECTION:POWER[:ABILITY_STEP], can be given many times (default 45:80)")
+    parser.add_argument("--show-snapshot", action="store_true", help="print the final level of every session")
+    args = parser.parse_args()
+    shots = args.shot or [(45.0, 80.0, -1)]
+
+    client = Client(args.socket)
+    scripts = {}
+    pending = {}
+    for i in range(args.sessions):
+        name = "s%d" % i
+        scripts[name] = session_script(name, args.level, shots)
+        pending[name] = next(scripts[name])
+        client.send(pending[name])
+
+    start = time.time()
+    failed = False
+    while pending:
+        line = client.read_line()
+        name, _, reply = line.partition(" ")
+        if name not in pending:
+            print(line, file=sys.stderr)
+            continue
+        if reply == "busy":
+            client.send(pending[name])
+            continue
+        if reply.startswith("error"):
+            print("%s: %s" % (name, reply), file=sys.stderr)
+            failed = True
+            del pending[name]
+            continue
+
+        command = pending[name].split()[0]
+        if command == "settle":
+            steps, score, pigs, settled, ended = reply.split()[1:6]
+            print("%s: score %s, %s pigs left, settled in %s steps%s" %
+                  (name, score, pigs, steps, ", level ended" if ended == "1" else ""))
+        elif command == "snapshot":
+            lines = [client.read_line() for _ in range(int(reply.split()[1]))]
+            if args.show_snapshot:
+                print("\n".join(lines))
+
+        try:
+            pending[name] = next(scripts[name])
+            client.send(pending[name])
+        except StopIteration:
+            del pending[name]
+
+    print("%d sessions in %.2f s" % (args.sessions, time.time() - start))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
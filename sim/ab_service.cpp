@@ -0,0 +1,502 @@
+// Simulation service: keeps many independent level sessions, each with its own world,
+// and runs the commands clients send over a Unix domain socket on a pool of workers.
+#include "../src/level.hpp"
+#include "../src/utils.hpp"
+#include "../src/resources.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <csignal>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+    const int default_max_steps = 3000; // 50 seconds of game time
+    const size_t default_queue_length = 16;
+    const size_t default_max_sessions = 1024;
+    const size_t max_line_length = 4096;
+
+    struct Options
+    {
+        std::string socket_path = "ab_service.sock";
+        int threads = 0;
+        size_t queue_length = default_queue_length;
+        size_t max_sessions = default_max_sessions;
+        int max_steps = default_max_steps;
+    };
+
+    void PrintUsage()
+    {
+        std::cerr << "Usage: ab_service [options]" << std::endl
+                  << "  --socket PATH       Unix domain socket to listen on (default ab_service.sock)" << std::endl
+                  << "  --threads N         worker threads (default all cores)" << std::endl
+                  << "  --queue N           commands waiting per session before replying busy (default " << default_queue_length << ")" << std::endl
+                  << "  --max-sessions N    sessions open at the same time (default " << default_max_sessions << ")" << std::endl
+                  << "  --max-steps N       most steps a single settle may take (default " << default_max_steps << ")" << std::endl;
+    }
+
+    bool ParseOptions(int argc, char *argv[], Options &options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+            if (arg == "--socket" && has_value)
+            {
+                options.socket_path = argv[++i];
+            }
+            else if (arg == "--threads" && has_value)
+            {
+                options.threads = std::atoi(argv[++i]);
+            }
+            else if (arg == "--queue" && has_value)
+            {
+                options.queue_length = std::max(1, std::atoi(argv[++i]));
+            }
+            else if (arg == "--max-sessions" && has_value)
+            {
+                options.max_sessions = std::max(1, std::atoi(argv[++i]));
+            }
+            else if (arg == "--max-steps" && has_value)
+            {
+                options.max_steps = std::atoi(argv[++i]);
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return options.max_steps > 0;
+    }
+
+    // One client socket. Replies of all its sessions are written through it by the workers.
+    class Connection
+    {
+    public:
+        explicit Connection(int fd) : fd_(fd) {}
+        ~Connection() { close(fd_); }
+
+        Connection(const Connection &) = delete;
+        Connection &operator=(const Connection &) = delete;
+
+        int GetFd() const { return fd_; }
+
+        // Writes the whole reply at once so replies of different sessions don't interleave
+        void Send(const std::string &text)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            size_t sent = 0;
+            while (sent < text.size())
+            {
+                ssize_t n = send(fd_, text.data() + sent, text.size() - sent, 0);
+                if (n <= 0)
+                {
+                    return; // The client is gone, its sessions are closed by the reader
+                }
+                sent += static_cast<size_t>(n);
+            }
+        }
+
+    private:
+        int fd_;
+        std::mutex mutex_;
+    };
+
+    struct Session
+    {
+        std::string name;
+        std::shared_ptr<Connection> connection;
+        std::unique_ptr<Level> level; // Only touched by the worker running the session
+
+        // Guarded by Service::mutex_
+        std::deque<std::string> commands;
+        bool scheduled = false; // Waiting in the ready queue or running on a worker
+        bool closed = false;
+    };
+
+    // Sessions run one command at a time, so a session is never on two workers at once
+    // and its commands run in the order they arrived. Sessions with queued commands
+    // take turns on the workers one command each.
+    class Service
+    {
+    public:
+        explicit Service(const Options &options) : options_(options)
+        {
+            int thread_count = options.threads > 0 ? options.threads : static_cast<int>(std::thread::hardware_concurrency());
+            for (int i = 0; i < std::max(1, thread_count); i++)
+            {
+                workers_.push_back(std::thread(&Service::Work, this));
+            }
+        }
+
+        ~Service()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            ready_cv_.notify_all();
+            for (auto &worker : workers_)
+            {
+                worker.join();
+            }
+        }
+
+        // Takes one request line of a client. Opening sessions and stats are answered right away,
+        // everything else goes to the session's queue or is answered with busy if the queue is full.
+        void Handle(const std::shared_ptr<Connection> &connection, const std::string &line)
+        {
+            std::stringstream request(line);
+            std::string command, name;
+            request >> command >> name;
+            if (command.empty())
+            {
+                return;
+            }
+            if (command == "stats")
+            {
+                std::string reply;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    size_t queued = 0;
+                    for (const auto &session : sessions_)
+                    {
+                        queued += session.second->commands.size();
+                    }
+                    reply = "- ok " + std::to_string(sessions_.size()) + " " + std::to_string(queued) + " " +
+                            std::to_string(workers_.size()) + "\n";
+                }
+                connection->Send(reply);
+                return;
+            }
+            if (name.empty())
+            {
+                connection->Send("- error missing session name\n");
+                return;
+            }
+
+            // Replies are sent after unlocking so a slow client can't hold up the other sessions
+            std::string reply = Enqueue(connection, command, name, line);
+            if (!reply.empty())
+            {
+                connection->Send(name + " " + reply + "\n");
+            }
+        }
+
+        // Closes every session of a client that went away
+        void Disconnect(const std::shared_ptr<Connection> &connection)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto it = sessions_.begin(); it != sessions_.end();)
+            {
+                if (it->second->connection == connection)
+                {
+                    it->second->commands.clear();
+                    it->second->closed = true;
+                    it = sessions_.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+
+    private:
+        // Returns the reply if the request is answered right away, empty if it was queued
+        std::string Enqueue(const std::shared_ptr<Connection> &connection, const std::string &command,
+                            const std::string &name, const std::string &line)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = sessions_.find(name);
+            if (command == "open")
+            {
+                if (it != sessions_.end())
+                {
+                    return "error session exists";
+                }
+                if (sessions_.size() >= options_.max_sessions)
+                {
+                    return "error too many sessions";
+                }
+                std::shared_ptr<Session> session(new Session());
+                session->name = name;
+                session->connection = connection;
+                sessions_[name] = session;
+                return "ok";
+            }
+            if (it == sessions_.end() || it->second->connection != connection)
+            {
+                return "error no such session";
+            }
+
+            Session &session = *it->second;
+            if (session.commands.size() >= options_.queue_length)
+            {
+                return "busy";
+            }
+            session.commands.push_back(line);
+            if (!session.scheduled)
+            {
+                session.scheduled = true;
+                ready_.push_back(it->second);
+                ready_cv_.notify_one();
+            }
+            return "";
+        }
+
+        void Work()
+        {
+            while (true)
+            {
+                std::shared_ptr<Session> session;
+                std::string command;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    ready_cv_.wait(lock, [this]()
+                                   { return stopping_ || !ready_.empty(); });
+                    if (stopping_)
+                    {
+                        return;
+                    }
+                    session = ready_.front();
+                    ready_.pop_front();
+                    if (session->closed || session->commands.empty())
+                    {
+                        session->scheduled = false;
+                        continue;
+                    }
+                    command = session->commands.front();
+                    session->commands.pop_front();
+                }
+
+                std::string reply = Run(*session, command);
+                session->connection->Send(session->name + " " + reply + "\n");
+
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (session->commands.empty() || session->closed)
+                {
+                    session->scheduled = false;
+                }
+                else
+                {
+                    ready_.push_back(session);
+                    ready_cv_.notify_one();
+                }
+            }
+        }
+
+        // Runs a command against the session's level and returns the reply without the session name
+        std::string Run(Session &session, const std::string &line)
+        {
+            std::stringstream request(line);
+            std::string command, name;
+            request >> command >> name;
+
+            if (command == "close")
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                session.commands.clear();
+                session.closed = true;
+                sessions_.erase(session.name);
+                return "ok";
+            }
+            if (command == "load")
+            {
+                std::string path;
+                request >> path;
+                std::string text;
+                if (!LevelText(path, text))
+                {
+                    return "error cannot read " + path;
+                }
+                std::stringstream input(text);
+                std::vector<std::string> errors;
+                LevelAsset asset = level_asset::Parse(input, errors);
+                if (!errors.empty())
+                {
+                    return "error " + errors.front();
+                }
+                if (asset.birds.empty())
+                {
+                    return "error level has no birds";
+                }
+                session.level.reset(new Level(asset));
+                return "ok " + std::to_string(session.level->CountPigs()) + " " + std::to_string(asset.birds.size());
+            }
+
+            Level *level = session.level.get();
+            if (level == nullptr)
+            {
+                return "error no level loaded";
+            }
+            if (command == "throw")
+            {
+                float direction, power;
+                if (!(request >> direction >> power))
+                {
+                    return "error usage: throw NAME DIRECTION POWER";
+                }
+                if (level->IsLevelEnded() || level->GetBird()->IsThrown())
+                {
+                    return "error no bird on the slingshot";
+                }
+                level->ThrowBird(0, Level::ThrowImpulse(direction, power));
+                return "ok";
+            }
+            if (command == "ability")
+            {
+                if (!level->GetBird()->IsThrown())
+                {
+                    return "error bird not thrown";
+                }
+                level->GetBird()->NewPower();
+                return "ok";
+            }
+            if (command == "step")
+            {
+                int steps = 1;
+                request >> steps;
+                int taken = 0;
+                bool moving = level->Advance(std::max(0, std::min(steps, options_.max_steps)), &taken);
+                return "ok " + std::to_string(taken) + " " + (moving ? "1" : "0");
+            }
+            if (command == "settle")
+            {
+                // Same rules as Game::Start: the next bird is put on the slingshot once the world settles
+                int max_steps = options_.max_steps;
+                request >> max_steps;
+                int taken = 0;
+                bool moving = level->Advance(std::max(0, std::min(max_steps, options_.max_steps)), &taken);
+                if (!moving && level->GetBird()->IsThrown())
+                {
+                    level->ResetBird();
+                }
+                return "ok " + std::to_string(taken) + " " + std::to_string(level->GetScore()) + " " +
+                       std::to_string(level->CountPigs()) + " " + (moving ? "0" : "1") + " " + (level->IsLevelEnded() ? "1" : "0");
+            }
+            if (command == "snapshot")
+            {
+                // The level in the .ab text format, the line count first so clients know where it ends
+                std::stringstream text;
+                level_asset::WriteText(text, level->Snapshot());
+                std::string body = text.str();
+                if (!body.empty() && body.back() == '\n')
+                {
+                    body.pop_back();
+                }
+                return "ok " + std::to_string(std::count(body.begin(), body.end(), '\n') + 1) + "\n" + body;
+            }
+            return "error unknown command " + command;
+        }
+
+        // Level files are read once and shared by all sessions
+        bool LevelText(const std::string &path, std::string &text)
+        {
+            std::lock_guard<std::mutex> lock(levels_mutex_);
+            auto it = level_texts_.find(path);
+            if (it == level_texts_.end())
+            {
+                std::ifstream file(path);
+                if (!file.good())
+                {
+                    return false;
+                }
+                std::stringstream contents;
+                contents << file.rdbuf();
+                it = level_texts_.emplace(path, contents.str()).first;
+            }
+            text = it->second;
+            return true;
+        }
+
+        Options options_;
+        std::mutex mutex_;
+        std::condition_variable ready_cv_;
+        std::deque<std::shared_ptr<Session>> ready_;
+        std::unordered_map<std::string, std::shared_ptr<Session>> sessions_;
+        bool stopping_ = false;
+        std::vector<std::thread> workers_;
+
+        std::mutex levels_mutex_;
+        std::unordered_map<std::string, std::string> level_texts_;
+    };
+
+    // Splits what a client sends into lines until it disconnects
+    void Serve(Service &service, std::shared_ptr<Connection> connection)
+    {
+        std::string buffer;
+        char chunk[4096];
+        ssize_t n;
+        while ((n = recv(connection->GetFd(), chunk, sizeof chunk, 0)) > 0)
+        {
+            buffer.append(chunk, static_cast<size_t>(n));
+            size_t end;
+            while ((end = buffer.find('\n')) != std::string::npos)
+            {
+                std::string line = buffer.substr(0, end);
+                buffer.erase(0, end + 1);
+                if (!line.empty() && line.back() == '\r')
+                {
+                    line.pop_back();
+                }
+                service.Handle(connection, line);
+            }
+            if (buffer.size() > max_line_length)
+            {
+                connection->Send("- error line too long\n");
+                break;
+            }
+        }
+        service.Disconnect(connection);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+    Resources::Get().SetMuted(true);
+    // Writing to a client that has gone away must not end the service
+    std::signal(SIGPIPE, SIG_IGN);
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (options.socket_path.size() >= sizeof address.sun_path)
+    {
+        std::cerr << "Socket path too long: " << options.socket_path << std::endl;
+        return 1;
+    }
+    options.socket_path.copy(address.sun_path, options.socket_path.size());
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(options.socket_path.c_str());
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof address) != 0 || listen(listener, 64) != 0)
+    {
+        std::cerr << "Listening on " << options.socket_path << " failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Listening on " << options.socket_path << std::endl;
+
+    Service service(options);
+    while (true)
+    {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0)
+        {
+            continue;
+        }
+        std::shared_ptr<Connection> connection(new Connection(fd));
+        std::thread(Serve, std::ref(service), connection).detach();
+    }
+}
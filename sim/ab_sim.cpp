@@ -0,0 +1,352 @@
+// Headless batch simulator: loads levels and runs scripted or swept shots
+// without a window, spreading independent runs over all cores.
+#include "../src/level.hpp"
+#include "../src/utils.hpp"
+#include "../src/resources.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+namespace
+{
+    const int default_max_steps = 3000; // 50 seconds of game time
+
+    struct Shot
+    {
+        float direction;  // Degrees, same as the aiming arrow
+        float power;      // 0-100, same as the aiming arrow
+        int ability_step; // Steps after the throw when the ability is used, negative for never
+    };
+
+    // One independent run: a fresh level and the shots thrown one after another
+    struct Job
+    {
+        size_t level;
+        std::vector<Shot> shots;
+    };
+
+    struct ShotResult
+    {
+        Shot shot;
+        int score;
+        int pigs_killed;
+        int steps_to_settle;
+        double wall_ms;
+    };
+
+    struct Range
+    {
+        float from;
+        float to;
+        int steps;
+
+        std::vector<float> Values() const
+        {
+            std::vector<float> values;
+            for (int i = 0; i < steps; i++)
+            {
+                values.push_back(steps == 1 ? from : from + (to - from) * i / (steps - 1));
+            }
+            return values;
+        }
+    };
+
+    struct Options
+    {
+        std::vector<std::string> levels;
+        Range directions = {0, 90, 10};
+        Range powers = {20, 100, 5};
+        Range abilities = {-1, -1, 1};
+        std::string script;
+        std::string format = "csv";
+        std::string output;
+        int threads = 0;
+        int max_steps = default_max_steps;
+    };
+
+    void PrintUsage()
+    {
+        std::cerr << "Usage: ab_sim [options] level.ab..." << std::endl
+                  << "  --directions FROM:TO:STEPS  aiming directions in degrees (default 0:90:10)" << std::endl
+                  << "  --powers FROM:TO:STEPS      throw powers 0-100 (default 20:100:5)" << std::endl
+                  << "  --ability FROM:TO:STEPS     steps after the throw when the ability is used, -1 for never (default -1:-1:1)" << std::endl
+                  << "  --script FILE               throw the shots in FILE one after another instead of a sweep," << std::endl
+                  << "                              one \"direction power ability_step\" per line" << std::endl
+                  << "  --threads N                 worker threads (default all cores)" << std::endl
+                  << "  --max-steps N               give up settling after N steps (default " << default_max_steps << ")" << std::endl
+                  << "  --format csv|json           output format (default csv)" << std::endl
+                  << "  --output FILE               write results to FILE instead of stdout" << std::endl;
+    }
+
+    bool ParseRange(const std::string &text, Range &range)
+    {
+        std::stringstream ss(text);
+        char _;
+        return static_cast<bool>(ss >> range.from >> _ >> range.to >> _ >> range.steps) && range.steps > 0;
+    }
+
+    bool ParseOptions(int argc, char *argv[], Options &options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+            if (arg == "--directions" && has_value)
+            {
+                if (!ParseRange(argv[++i], options.directions))
+                    return false;
+            }
+            else if (arg == "--powers" && has_value)
+            {
+                if (!ParseRange(argv[++i], options.powers))
+                    return false;
+            }
+            else if (arg == "--ability" && has_value)
+            {
+                if (!ParseRange(argv[++i], options.abilities))
+                    return false;
+            }
+            else if (arg == "--script" && has_value)
+            {
+                options.script = argv[++i];
+            }
+            else if (arg == "--threads" && has_value)
+            {
+                options.threads = std::atoi(argv[++i]);
+            }
+            else if (arg == "--max-steps" && has_value)
+            {
+                options.max_steps = std::atoi(argv[++i]);
+            }
+            else if (arg == "--format" && has_value)
+            {
+                options.format = argv[++i];
+                if (options.format != "csv" && options.format != "json")
+                    return false;
+            }
+            else if (arg == "--output" && has_value)
+            {
+                options.output = argv[++i];
+            }
+            else if (arg.size() > 1 && arg[0] == '-')
+            {
+                return false;
+            }
+            else
+            {
+                options.levels.push_back(arg);
+            }
+        }
+        return !options.levels.empty();
+    }
+
+    bool ReadScript(const std::string &filename, std::vector<Shot> &shots)
+    {
+        std::ifstream file(filename);
+        if (!file.good())
+        {
+            return false;
+        }
+        std::string line;
+        while (std::getline(file, line))
+        {
+            std::stringstream ss(line);
+            Shot shot;
+            if (ss >> shot.direction >> shot.power)
+            {
+                if (!(ss >> shot.ability_step))
+                {
+                    shot.ability_step = -1;
+                }
+                shots.push_back(shot);
+            }
+        }
+        return !shots.empty();
+    }
+
+    // Steps until nothing moves, returns the number of steps taken
+    int Settle(Level &level, int max_steps)
+    {
+        int steps = 0;
+        level.Advance(max_steps, &steps);
+        return steps;
+    }
+
+    std::vector<ShotResult> Run(const LevelAsset &asset, const Job &job, int max_steps)
+    {
+        std::vector<ShotResult> results;
+        Level level(asset);
+        Settle(level, max_steps);
+        int initial_pigs = level.CountPigs();
+
+        for (const auto &shot : job.shots)
+        {
+            if (level.IsLevelEnded())
+            {
+                break;
+            }
+            auto start = std::chrono::steady_clock::now();
+
+            // Same rules as Game::Start: throw, use the ability on the given step and
+            // reset the bird once the world has settled
+            level.ThrowBird(0, Level::ThrowImpulse(shot.direction, shot.power));
+            int steps = 0;
+            bool moving = true;
+            while (moving && steps < max_steps)
+            {
+                if (steps == shot.ability_step)
+                {
+                    level.GetBird()->NewPower();
+                }
+                moving = level.Step();
+                steps++;
+            }
+            level.ResetBird();
+
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            results.push_back({shot, level.GetScore(), initial_pigs - level.CountPigs(), steps, elapsed.count()});
+        }
+        return results;
+    }
+
+    void WriteCsv(std::ostream &out, const Options &options, const std::vector<Job> &jobs, const std::vector<std::vector<ShotResult>> &results)
+    {
+        out << "level,run,shot,direction,power,ability_step,score,pigs_killed,steps_to_settle,wall_ms" << std::endl;
+        for (size_t run = 0; run < jobs.size(); run++)
+        {
+            for (size_t i = 0; i < results[run].size(); i++)
+            {
+                const ShotResult &r = results[run][i];
+                out << options.levels[jobs[run].level] << "," << run << "," << i << "," << r.shot.direction << ","
+                    << r.shot.power << "," << r.shot.ability_step << "," << r.score << "," << r.pigs_killed << ","
+                    << r.steps_to_settle << "," << r.wall_ms << std::endl;
+            }
+        }
+    }
+
+    void WriteJson(std::ostream &out, const Options &options, const std::vector<Job> &jobs, const std::vector<std::vector<ShotResult>> &results)
+    {
+        out << "[" << std::endl;
+        bool first = true;
+        for (size_t run = 0; run < jobs.size(); run++)
+        {
+            for (size_t i = 0; i < results[run].size(); i++)
+            {
+                const ShotResult &r = results[run][i];
+                out << (first ? "" : ",\n")
+                    << "  {\"level\": \"" << options.levels[jobs[run].level] << "\", \"run\": " << run << ", \"shot\": " << i
+                    << ", \"direction\": " << r.shot.direction << ", \"power\": " << r.shot.power
+                    << ", \"ability_step\": " << r.shot.ability_step << ", \"score\": " << r.score
+                    << ", \"pigs_killed\": " << r.pigs_killed << ", \"steps_to_settle\": " << r.steps_to_settle
+                    << ", \"wall_ms\": " << r.wall_ms << "}";
+                first = false;
+            }
+        }
+        out << std::endl
+            << "]" << std::endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+    Resources::Get().SetMuted(true);
+
+    // Every level is parsed once here and each run builds its level from the parsed asset
+    std::vector<LevelAsset> level_assets;
+    for (const auto &filename : options.levels)
+    {
+        std::ifstream file(filename);
+        if (!file.good())
+        {
+            std::cerr << "Level loading failed for file: " << filename << std::endl;
+            return 1;
+        }
+        std::vector<std::string> errors;
+        level_assets.push_back(level_asset::Parse(file, errors));
+        for (const auto &error : errors)
+        {
+            std::cerr << filename << ": " << error << std::endl;
+        }
+        if (!errors.empty())
+        {
+            return 1;
+        }
+        if (level_assets.back().birds.empty())
+        {
+            std::cerr << filename << ": level has no birds" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<Shot> script;
+    if (!options.script.empty() && !ReadScript(options.script, script))
+    {
+        std::cerr << "Reading shot script failed: " << options.script << std::endl;
+        return 1;
+    }
+
+    std::vector<Job> jobs;
+    for (size_t level = 0; level < options.levels.size(); level++)
+    {
+        if (!script.empty())
+        {
+            jobs.push_back({level, script});
+            continue;
+        }
+        for (float direction : options.directions.Values())
+        {
+            for (float power : options.powers.Values())
+            {
+                for (float ability : options.abilities.Values())
+                {
+                    jobs.push_back({level, {{direction, power, static_cast<int>(ability)}}});
+                }
+            }
+        }
+    }
+
+    int thread_count = options.threads > 0 ? options.threads : static_cast<int>(std::thread::hardware_concurrency());
+    thread_count = std::max(1, std::min(thread_count, static_cast<int>(jobs.size())));
+
+    // Each run has its own level and world so workers only share the job counter
+    std::vector<std::vector<ShotResult>> results(jobs.size());
+    std::atomic<size_t> next_job(0);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < thread_count; i++)
+    {
+        workers.push_back(std::thread([&]()
+                                      {
+                                          for (size_t job = next_job++; job < jobs.size(); job = next_job++)
+                                          {
+                                              results[job] = Run(level_assets[jobs[job].level], jobs[job], options.max_steps);
+                                          } }));
+    }
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    std::ofstream file;
+    if (!options.output.empty())
+    {
+        file.open(options.output);
+    }
+    std::ostream &out = options.output.empty() ? std::cout : file;
+    if (options.format == "json")
+    {
+        WriteJson(out, options, jobs, results);
+    }
+    else
+    {
+        WriteCsv(out, options, jobs, results);
+    }
+
+    return 0;
+}
@@ -0,0 +1,272 @@
+#include "asset_loader.hpp"
+#include "memory_stats.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+    const unsigned max_workers = 4;
+
+    long long ImageBytes(const sf::Image &image)
+    {
+        return 4LL * image.getSize().x * image.getSize().y;
+    }
+
+    const char *KindName(AssetKind kind)
+    {
+        switch (kind)
+        {
+        case AssetKind::Texture:
+            return "texture";
+        case AssetKind::Image:
+            return "image";
+        case AssetKind::Font:
+            return "font";
+        default:
+            return "sound";
+        }
+    }
+}
+
+AssetLoader &AssetLoader::Get()
+{
+    static AssetLoader loader;
+    return loader;
+}
+
+AssetLoader::~AssetLoader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.clear();
+    }
+    for (auto &worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+void AssetLoader::Queue(const std::string &path, AssetKind kind)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (assets_.count(path) > 0)
+    {
+        return;
+    }
+    if (assets_.empty())
+    {
+        clock_.restart();
+    }
+    std::unique_ptr<Asset> asset(new Asset());
+    asset->path = path;
+    asset->kind = kind;
+    queue_.push_back(asset.get());
+    assets_[path] = std::move(asset);
+
+    // Workers quit when the queue runs empty, start more while there is work
+    unsigned pool_size = std::max(1u, std::min(max_workers, std::thread::hardware_concurrency()));
+    if (running_ < static_cast<int>(pool_size) && running_ < static_cast<int>(queue_.size()))
+    {
+        running_++;
+        workers_.emplace_back(&AssetLoader::Run, this);
+    }
+}
+
+void AssetLoader::Run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!queue_.empty())
+    {
+        Asset *asset = queue_.front();
+        queue_.pop_front();
+        asset->state = State::Decoding;
+
+        lock.unlock();
+        Decode(*asset);
+        lock.lock();
+
+        asset->state = State::Decoded;
+        decoded_.notify_all();
+    }
+    running_--;
+}
+
+void AssetLoader::Decode(Asset &asset)
+{
+    sf::Clock clock;
+    switch (asset.kind)
+    {
+    case AssetKind::Texture:
+    case AssetKind::Image:
+        asset.failed = !asset.image.loadFromFile(asset.path);
+        memory_stats::Add(MemoryTag::Images, ImageBytes(asset.image));
+        break;
+    case AssetKind::Font:
+        asset.failed = !asset.font.loadFromFile(asset.path);
+        break;
+    case AssetKind::Sound:
+    {
+        sf::InputSoundFile file;
+        asset.failed = !file.openFromFile(asset.path);
+        if (!asset.failed)
+        {
+            asset.samples.resize(static_cast<size_t>(file.getSampleCount()));
+            file.read(asset.samples.data(), asset.samples.size());
+            asset.channel_count = file.getChannelCount();
+            asset.sample_rate = file.getSampleRate();
+            memory_stats::Add(MemoryTag::Audio, asset.samples.size() * sizeof(sf::Int16));
+        }
+        break;
+    }
+    }
+    asset.decode_ms = clock.getElapsedTime().asSeconds() * 1000;
+}
+
+void AssetLoader::Finish(Asset &asset)
+{
+    sf::Clock clock;
+    if (asset.failed)
+    {
+        std::cerr << "Failed to load " << asset.path << std::endl;
+    }
+    else if (asset.kind == AssetKind::Texture)
+    {
+        asset.texture.loadFromImage(asset.image);
+        memory_stats::Add(MemoryTag::Textures, ImageBytes(asset.image));
+        memory_stats::Add(MemoryTag::Images, -ImageBytes(asset.image));
+        asset.image = sf::Image(); // Only the GPU copy is needed from now on
+    }
+    else if (asset.kind == AssetKind::Sound)
+    {
+        asset.sound.loadFromSamples(asset.samples.data(), asset.samples.size(), asset.channel_count, asset.sample_rate);
+        std::vector<sf::Int16>().swap(asset.samples);
+    }
+    asset.upload_ms = clock.getElapsedTime().asSeconds() * 1000;
+    asset.state = State::Ready;
+}
+
+void AssetLoader::Update()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &it : assets_)
+    {
+        if (it.second->state == State::Decoded)
+        {
+            Finish(*it.second);
+        }
+    }
+    if (running_ == 0 && !workers_.empty())
+    {
+        for (auto &worker : workers_)
+        {
+            worker.join();
+        }
+        workers_.clear();
+    }
+}
+
+bool AssetLoader::IsDone()
+{
+    return GetProgress() >= 1.0f;
+}
+
+float AssetLoader::GetProgress()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (assets_.empty())
+    {
+        return 1.0f;
+    }
+    size_t ready = std::count_if(assets_.begin(), assets_.end(), [](const std::pair<const std::string, std::unique_ptr<Asset>> &it)
+                                 { return it.second->state == State::Ready; });
+    if (ready == assets_.size() && total_ms_ == 0)
+    {
+        total_ms_ = clock_.getElapsedTime().asSeconds() * 1000;
+    }
+    return static_cast<float>(ready) / assets_.size();
+}
+
+AssetLoader::Asset &AssetLoader::Load(const std::string &path, AssetKind kind)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = assets_.find(path);
+    Asset *asset;
+    if (it == assets_.end())
+    {
+        asset = new Asset();
+        asset->path = path;
+        asset->kind = kind;
+        asset->state = State::Decoding;
+        assets_[path].reset(asset);
+    }
+    else
+    {
+        asset = it->second.get();
+        if (asset->state == State::Queued)
+        {
+            // Needed right now, don't wait for a worker to get to it
+            queue_.erase(std::find(queue_.begin(), queue_.end(), asset));
+            asset->state = State::Decoding;
+        }
+        else
+        {
+            decoded_.wait(lock, [asset]
+                          { return asset->state != State::Decoding; });
+        }
+    }
+
+    if (asset->state == State::Decoding)
+    {
+        lock.unlock();
+        Decode(*asset);
+        lock.lock();
+        asset->state = State::Decoded;
+        decoded_.notify_all(); // Other threads may be waiting for the same asset
+    }
+    if (asset->state == State::Decoded)
+    {
+        Finish(*asset);
+    }
+    return *asset;
+}
+
+sf::Texture &AssetLoader::GetTexture(const std::string &path)
+{
+    return Load(path, AssetKind::Texture).texture;
+}
+
+const sf::Font &AssetLoader::GetFont(const std::string &path)
+{
+    return Load(path, AssetKind::Font).font;
+}
+
+const sf::SoundBuffer &AssetLoader::GetSoundBuffer(const std::string &path)
+{
+    return Load(path, AssetKind::Sound).sound;
+}
+
+sf::Image AssetLoader::TakeImage(const std::string &path)
+{
+    Asset &asset = Load(path, AssetKind::Image);
+    std::lock_guard<std::mutex> lock(mutex_);
+    sf::Image image = asset.image;
+    memory_stats::Add(MemoryTag::Images, -ImageBytes(image));
+    asset.image = sf::Image();
+    return image;
+}
+
+void AssetLoader::PrintReport(std::ostream &output)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    output << std::fixed << std::setprecision(1);
+    for (const auto &it : assets_)
+    {
+        const Asset &asset = *it.second;
+        output << "Loaded " << KindName(asset.kind) << " " << asset.path << ": decode " << asset.decode_ms
+               << " ms, upload " << asset.upload_ms << " ms" << (asset.failed ? " (failed)" : "") << std::endl;
+    }
+    output << "Startup assets ready in " << total_ms_ << " ms" << std::endl;
+    output.unsetf(std::ios::floatfield);
+    output << std::setprecision(6);
+}
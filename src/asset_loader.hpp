@@ -0,0 +1,98 @@
+#ifndef ANGRY_BIRDS_ASSET_LOADER
+#define ANGRY_BIRDS_ASSET_LOADER
+
+#include <SFML/Graphics.hpp>
+#include <SFML/Audio.hpp>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class AssetKind
+{
+    Texture, // Decoded on a worker, uploaded on the main thread
+    Image,   // Decoded on a worker and kept in memory only
+    Font,
+    Sound // Decoded into samples on a worker, the sound buffer is created on the main thread
+};
+
+// Shared store of images, fonts and sounds loaded from files. Queued files are
+// decoded on a small thread pool. OpenGL and OpenAL objects are only created
+// on the main thread, either in Update or when an asset is first asked for.
+class AssetLoader
+{
+public:
+    static AssetLoader &Get();
+
+    ~AssetLoader();
+
+    // Starts decoding the file in the background, files already known are ignored
+    void Queue(const std::string &path, AssetKind kind);
+
+    // Creates textures and sound buffers for the files decoded so far, call from the main thread
+    void Update();
+
+    // True when every queued file is ready to use
+    bool IsDone();
+
+    // Fraction of the queued files that are ready
+    float GetProgress();
+
+    // These wait for a queued file to finish or load it right away if it wasn't queued
+    sf::Texture &GetTexture(const std::string &path);
+    const sf::Font &GetFont(const std::string &path);
+    const sf::SoundBuffer &GetSoundBuffer(const std::string &path);
+
+    // Moves a decoded image out of the store, for images that are only needed once
+    sf::Image TakeImage(const std::string &path);
+
+    // Decode and upload time of every file and the time since the first file was queued
+    void PrintReport(std::ostream &output);
+
+private:
+    enum class State
+    {
+        Queued,
+        Decoding,
+        Decoded,
+        Ready
+    };
+
+    struct Asset
+    {
+        std::string path;
+        AssetKind kind;
+        State state = State::Queued;
+        bool failed = false;
+        sf::Image image;
+        sf::Texture texture;
+        sf::Font font;
+        std::vector<sf::Int16> samples;
+        unsigned channel_count = 0;
+        unsigned sample_rate = 0;
+        sf::SoundBuffer sound;
+        float decode_ms = 0;
+        float upload_ms = 0;
+    };
+
+    AssetLoader() {}
+    Asset &Load(const std::string &path, AssetKind kind);
+    void Run();
+    static void Decode(Asset &asset);
+    static void Finish(Asset &asset);
+
+    std::map<std::string, std::unique_ptr<Asset>> assets_;
+    std::deque<Asset *> queue_;
+    std::vector<std::thread> workers_;
+    int running_ = 0;
+    std::mutex mutex_;
+    std::condition_variable decoded_;
+    sf::Clock clock_; // Restarted when the first file is queued
+    float total_ms_ = 0;
+};
+
+#endif // ANGRY_BIRDS_ASSET_LOADER
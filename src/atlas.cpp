@@ -0,0 +1,267 @@
+#include "atlas.hpp"
+#include "converters.hpp"
+#include "utils.hpp"
+#include "asset_loader.hpp"
+#include "memory_stats.hpp"
+#include <algorithm>
+
+namespace
+{
+    const unsigned atlas_page_size = 2048;
+    const unsigned atlas_padding = 2; // Empty pixels between images so scaled sprites don't bleed
+
+    // Every image drawn from the atlas, named after the file in resources/images
+    const std::vector<std::string> atlas_images = {
+        "bird", "bird2", "bird3", "pig", "box", "slingshot", "pause", "home",
+        "highscore", "level_end", "last_level_end",
+        "0_stars", "1_stars", "2_stars", "3_stars"};
+
+    std::string ImagePath(const std::string &name)
+    {
+        return "resources/images/" + name + ".png";
+    }
+
+    // A horizontal strip of a page, images are placed on it left to right
+    std::string PagePath(int page)
+    {
+        return cache_directory + "/atlas" + std::to_string(page) + ".png";
+    }
+
+    struct Shelf
+    {
+        int page;
+        unsigned y;
+        unsigned height;
+        unsigned used_width;
+    };
+}
+
+TextureAtlas &TextureAtlas::Get()
+{
+    static TextureAtlas atlas;
+    return atlas;
+}
+
+void TextureAtlas::Preload()
+{
+    std::ifstream manifest(cache_directory + "/atlas.txt");
+    int page_count = 0;
+    manifest >> page_count;
+    for (int i = 0; i < page_count; i++)
+    {
+        AssetLoader::Get().Queue(PagePath(i), AssetKind::Image);
+    }
+}
+
+TextureAtlas::TextureAtlas()
+{
+    Build(atlas_images);
+}
+
+bool TextureAtlas::Build(const std::vector<std::string> &names)
+{
+    pages_.clear();
+    regions_.clear();
+    sources_.clear();
+    for (auto name : names)
+    {
+        sources_[name] = {utils::FileSize(ImagePath(name)), utils::FileModified(ImagePath(name))};
+    }
+
+    if (LoadCache(names))
+    {
+        return true;
+    }
+
+    std::vector<sf::Image> images(names.size());
+    std::vector<size_t> order;
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        if (!images[i].loadFromFile(ImagePath(names[i])))
+        {
+            std::cerr << "Atlas: failed to load image " << names[i] << std::endl;
+            continue;
+        }
+        order.push_back(i);
+    }
+
+    unsigned page_size = std::min(atlas_page_size, sf::Texture::getMaximumSize());
+
+    // Tallest images first, each goes to the first shelf it fits on
+    std::sort(order.begin(), order.end(), [&images](size_t a, size_t b)
+              { return images[a].getSize().y > images[b].getSize().y; });
+
+    std::vector<Shelf> shelves;
+    std::vector<unsigned> page_heights;
+    for (auto i : order)
+    {
+        unsigned w = images[i].getSize().x + atlas_padding;
+        unsigned h = images[i].getSize().y + atlas_padding;
+        if (w > page_size || h > page_size)
+        {
+            std::cerr << "Atlas: image " << names[i] << " doesn't fit on an atlas page" << std::endl;
+            continue;
+        }
+
+        auto shelf = std::find_if(shelves.begin(), shelves.end(), [w, h, page_size](const Shelf &s)
+                                  { return h <= s.height && s.used_width + w <= page_size; });
+        if (shelf == shelves.end())
+        {
+            if (page_heights.empty() || page_heights.back() + h > page_size)
+            {
+                page_heights.push_back(0);
+            }
+            Shelf new_shelf = {static_cast<int>(page_heights.size()) - 1, page_heights.back(), h, 0};
+            page_heights.back() += h;
+            shelves.push_back(new_shelf);
+            shelf = shelves.end() - 1;
+        }
+
+        Region region = {shelf->page, sf::IntRect(shelf->used_width, shelf->y, images[i].getSize().x, images[i].getSize().y)};
+        regions_[names[i]] = region;
+        shelf->used_width += w;
+    }
+
+    std::vector<sf::Image> page_images(page_heights.size());
+    for (auto &page_image : page_images)
+    {
+        page_image.create(page_size, page_size, sf::Color::Transparent);
+    }
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        auto it = regions_.find(names[i]);
+        if (it != regions_.end())
+        {
+            page_images[it->second.page].copy(images[i], it->second.rect.left, it->second.rect.top);
+        }
+    }
+
+    pages_.resize(page_images.size());
+    for (size_t i = 0; i < page_images.size(); i++)
+    {
+        pages_[i].loadFromImage(page_images[i]);
+        memory_stats::Add(MemoryTag::Textures, 4LL * page_size * page_size);
+    }
+
+    SaveCache(page_images);
+    return regions_.size() == names.size();
+}
+
+bool TextureAtlas::LoadCache(const std::vector<std::string> &names)
+{
+    std::ifstream manifest(cache_directory + "/atlas.txt");
+    if (!manifest.good())
+    {
+        return false;
+    }
+
+    int page_count;
+    manifest >> page_count;
+    std::map<std::string, Region> regions;
+    std::string name;
+    Region region;
+    SourceStamp stamp;
+    while (manifest >> name >> region.page >> region.rect.left >> region.rect.top >> region.rect.width >> region.rect.height >> stamp.size >> stamp.modified)
+    {
+        // Rebuild if any of the source images has been changed, edited PNGs often keep their size
+        auto source = sources_.find(name);
+        if (source == sources_.end() || source->second.size != stamp.size || source->second.modified != stamp.modified ||
+            region.page >= page_count)
+        {
+            return false;
+        }
+        regions[name] = region;
+    }
+    if (regions.size() != names.size())
+    {
+        return false;
+    }
+
+    pages_.resize(page_count);
+    for (int i = 0; i < page_count; i++)
+    {
+        sf::Image page = AssetLoader::Get().TakeImage(PagePath(i));
+        if (page.getSize().x == 0 || !pages_[i].loadFromImage(page))
+        {
+            pages_.clear();
+            return false;
+        }
+    }
+    for (const auto &page : pages_)
+    {
+        memory_stats::Add(MemoryTag::Textures, 4LL * page.getSize().x * page.getSize().y);
+    }
+    regions_ = regions;
+    return true;
+}
+
+void TextureAtlas::SaveCache(const std::vector<sf::Image> &page_images) const
+{
+    utils::MakeDirectory(cache_directory);
+    for (size_t i = 0; i < page_images.size(); i++)
+    {
+        page_images[i].saveToFile(PagePath(static_cast<int>(i)));
+    }
+
+    // One line per image: name page left top width height source_file_size source_modified_time
+    std::ofstream manifest(cache_directory + "/atlas.txt");
+    manifest << page_images.size() << std::endl;
+    for (auto region : regions_)
+    {
+        const sf::IntRect &rc = region.second.rect;
+        manifest << region.first << " " << region.second.page << " " << rc.left << " " << rc.top << " "
+                 << rc.width << " " << rc.height << " " << sources_.at(region.first).size << " " << sources_.at(region.first).modified << std::endl;
+    }
+}
+
+bool TextureAtlas::Contains(const std::string &name) const
+{
+    return regions_.count(name) > 0;
+}
+
+TextureAtlas::Region TextureAtlas::GetRegion(const std::string &name) const
+{
+    auto it = regions_.find(name);
+    if (it == regions_.end())
+    {
+        std::cerr << "Atlas: unknown image " << name << std::endl;
+        return {0, sf::IntRect(0, 0, 0, 0)};
+    }
+    return it->second;
+}
+
+int TextureAtlas::PageOf(const sf::Texture *texture) const
+{
+    for (size_t i = 0; i < pages_.size(); i++)
+    {
+        if (&pages_[i] == texture)
+        {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void TextureAtlas::Apply(sf::Sprite &sprite, const std::string &name) const
+{
+    Apply(sprite, GetRegion(name));
+}
+
+void TextureAtlas::Apply(sf::Sprite &sprite, const Region &region) const
+{
+    if (region.page < GetPageCount())
+    {
+        sprite.setTexture(pages_[region.page]);
+        sprite.setTextureRect(region.rect);
+    }
+}
+
+void TextureAtlas::Apply(sf::Shape &shape, const std::string &name) const
+{
+    Region region = GetRegion(name);
+    if (region.page < GetPageCount())
+    {
+        shape.setTexture(&pages_[region.page]);
+        shape.setTextureRect(region.rect);
+    }
+}
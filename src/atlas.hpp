@@ -0,0 +1,62 @@
+#ifndef ANGRY_BIRDS_ATLAS
+#define ANGRY_BIRDS_ATLAS
+
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+#include <map>
+
+// Packs the small game sprites into one or a few atlas textures so that
+// everything sharing a page can be drawn with a single draw call.
+// The atlas is built on first use and cached to disk with a rectangle manifest.
+class TextureAtlas
+{
+public:
+    // Location of a single image inside the atlas
+    struct Region
+    {
+        int page;
+        sf::IntRect rect;
+    };
+
+    static TextureAtlas &Get();
+
+    // Starts decoding the cached atlas pages in the background
+    static void Preload();
+
+    // Packs the named images (resources/images/<name>.png) into atlas pages
+    bool Build(const std::vector<std::string> &names);
+
+    bool Contains(const std::string &name) const;
+
+    Region GetRegion(const std::string &name) const;
+
+    const sf::Texture &GetTexture(int page) const { return pages_[page]; }
+
+    int GetPageCount() const { return static_cast<int>(pages_.size()); }
+
+    // Returns the page the texture belongs to or -1 if it is not an atlas page
+    int PageOf(const sf::Texture *texture) const;
+
+    // Point a sprite or a shape to the named sub-rectangle
+    void Apply(sf::Sprite &sprite, const std::string &name) const;
+    void Apply(sf::Sprite &sprite, const Region &region) const;
+    void Apply(sf::Shape &shape, const std::string &name) const;
+
+private:
+    TextureAtlas();
+    bool LoadCache(const std::vector<std::string> &names);
+    void SaveCache(const std::vector<sf::Image> &page_images) const;
+
+    std::vector<sf::Texture> pages_;
+    std::map<std::string, Region> regions_;
+    // Size and modification time of every source image, a change in either rebuilds the atlas
+    struct SourceStamp
+    {
+        long size;
+        long long modified;
+    };
+    std::map<std::string, SourceStamp> sources_;
+};
+
+#endif // ANGRY_BIRDS_ATLAS
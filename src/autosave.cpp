@@ -0,0 +1,157 @@
+#include "autosave.hpp"
+#include "converters.hpp"
+#include "utils.hpp"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#ifdef _WIN32
+#include <io.h>
+#define sync_file(file) _commit(_fileno(file))
+#else
+#include <unistd.h>
+#define sync_file(file) fsync(fileno(file))
+#endif
+
+namespace
+{
+    const std::string save_directory = "saves";
+    const int save_slot_count = 3;
+    const size_t max_queued_saves = 2;
+
+    std::string SlotPath(int slot)
+    {
+        return save_directory + "/autosave" + std::to_string(slot) + "." + file_suffix;
+    }
+
+    std::string IndexPath()
+    {
+        return save_directory + "/autosave.txt";
+    }
+
+    // Writes to a temporary file first so a crash mid-write never leaves a half written save.
+    // The data is synced to disk before the rename, otherwise the rename can land first.
+    bool WriteAtomically(const std::string &path, const std::string &contents)
+    {
+        std::string temp_path = path + ".tmp";
+        FILE *file = std::fopen(temp_path.c_str(), "wb");
+        if (file == nullptr)
+        {
+            return false;
+        }
+        bool written = std::fwrite(contents.data(), 1, contents.size(), file) == contents.size() &&
+                       std::fflush(file) == 0 && sync_file(file) == 0;
+        written = std::fclose(file) == 0 && written;
+        if (!written)
+        {
+            return false;
+        }
+#ifdef _WIN32
+        std::remove(path.c_str()); // rename doesn't replace existing files on Windows
+#endif
+        return std::rename(temp_path.c_str(), path.c_str()) == 0;
+    }
+}
+
+Autosaver::Autosaver() : thread_(&Autosaver::Run, this)
+{
+}
+
+Autosaver::~Autosaver()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+void Autosaver::Save(LevelAsset snapshot, const std::string &level_file)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.size() >= max_queued_saves)
+        {
+            queue_.pop_front();
+        }
+        queue_.push_back({std::move(snapshot), level_file});
+    }
+    wake_.notify_one();
+}
+
+void Autosaver::Discard()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.clear();
+        discarding_ = true;
+    }
+    wake_.notify_one();
+}
+
+std::string Autosaver::LatestSave(std::string &level_file)
+{
+    // The slot on the first line, the level file on the second
+    std::ifstream index(IndexPath());
+    int slot;
+    if (index >> slot && slot >= 0 && slot < save_slot_count)
+    {
+        index.ignore();
+        if (std::getline(index, level_file) && !level_file.empty())
+        {
+            return SlotPath(slot);
+        }
+    }
+    return "";
+}
+
+void Autosaver::Run()
+{
+    utils::MakeDirectory(save_directory);
+    // Continue the rotation after the newest save of the previous run
+    std::ifstream index(IndexPath());
+    int slot;
+    if (index >> slot && slot >= 0 && slot < save_slot_count)
+    {
+        next_slot_ = (slot + 1) % save_slot_count;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        wake_.wait(lock, [this]
+                   { return stopping_ || discarding_ || !queue_.empty(); });
+        if (discarding_)
+        {
+            // Saves queued after the discard are still written below
+            discarding_ = false;
+            lock.unlock();
+            std::remove(IndexPath().c_str());
+            lock.lock();
+            continue;
+        }
+        if (queue_.empty())
+        {
+            return; // Stopping and everything has been written
+        }
+        PendingSave save = std::move(queue_.front());
+        queue_.pop_front();
+
+        lock.unlock();
+        Write(save);
+        lock.lock();
+    }
+}
+
+void Autosaver::Write(const PendingSave &save)
+{
+    std::stringstream text;
+    level_asset::WriteText(text, save.snapshot);
+    if (!WriteAtomically(SlotPath(next_slot_), text.str()) ||
+        !WriteAtomically(IndexPath(), std::to_string(next_slot_) + "\n" + save.level_file + "\n"))
+    {
+        std::cerr << "Autosave: failed to write " << SlotPath(next_slot_) << std::endl;
+        return;
+    }
+    next_slot_ = (next_slot_ + 1) % save_slot_count;
+}
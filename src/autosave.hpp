@@ -0,0 +1,53 @@
+#ifndef ANGRY_BIRDS_AUTOSAVE
+#define ANGRY_BIRDS_AUTOSAVE
+
+#include "level_asset.hpp"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Writes level snapshots to disk on a background thread so that saving never
+// stalls a frame. Saves rotate through a fixed number of slots in saves/ and
+// saves/autosave.txt names the newest one and the level file it was made from.
+class Autosaver
+{
+public:
+    Autosaver();
+    ~Autosaver(); // Writes whatever is still queued before returning
+
+    Autosaver(const Autosaver &) = delete;
+    Autosaver &operator=(const Autosaver &) = delete;
+
+    // Queues a snapshot, never blocks. When the writer falls behind the oldest
+    // queued snapshot is dropped since a newer one replaces it anyway.
+    void Save(LevelAsset snapshot, const std::string &level_file);
+
+    // Forgets the newest save once its attempt is over so it isn't offered again
+    void Discard();
+
+    // Path of the newest save or an empty string if there is none, level_file is
+    // set to the level it was made from
+    static std::string LatestSave(std::string &level_file);
+
+private:
+    struct PendingSave
+    {
+        LevelAsset snapshot;
+        std::string level_file;
+    };
+
+    void Run();
+    void Write(const PendingSave &save);
+
+    std::deque<PendingSave> queue_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    bool discarding_ = false;
+    int next_slot_ = 0;
+    std::thread thread_; // Last so everything above exists before the thread starts
+};
+
+#endif // ANGRY_BIRDS_AUTOSAVE
@@ -0,0 +1,58 @@
+#ifndef ANGRY_BIRDS_B2_USER_SETTINGS
+#define ANGRY_BIRDS_B2_USER_SETTINGS
+
+// Box2D includes this instead of its default settings when B2_USER_SETTINGS is
+// defined (see CMakeLists.txt). It is the same as the defaults except that all
+// Box2D allocations are counted in the memory report.
+
+#include <stdarg.h>
+#include <stdint.h>
+
+#define b2_lengthUnitsPerMeter 1.0f
+#define b2_maxPolygonVertices 8
+
+struct B2_API b2BodyUserData
+{
+    b2BodyUserData() { pointer = 0; }
+    uintptr_t pointer; // Object *
+};
+
+struct B2_API b2FixtureUserData
+{
+    b2FixtureUserData() { pointer = 0; }
+    uintptr_t pointer; // Object *
+};
+
+struct B2_API b2JointUserData
+{
+    b2JointUserData() { pointer = 0; }
+    uintptr_t pointer;
+};
+
+namespace memory_stats
+{
+    void *Box2DAlloc(int size);
+    void Box2DFree(void *memory);
+}
+
+inline void *b2Alloc(int32 size)
+{
+    return memory_stats::Box2DAlloc(size);
+}
+
+inline void b2Free(void *mem)
+{
+    memory_stats::Box2DFree(mem);
+}
+
+B2_API void b2Log_Default(const char *string, va_list args);
+
+inline void b2Log(const char *string, ...)
+{
+    va_list args;
+    va_start(args, string);
+    b2Log_Default(string, args);
+    va_end(args);
+}
+
+#endif // ANGRY_BIRDS_B2_USER_SETTINGS
@@ -6,22 +6,11 @@
 class Bird : public Object
 {
 public:
-    Bird(b2Body *body, std::string texture_file, float b2_radius) : Object(texture_file, body)
-    {
-        body_ = body;
-        int w = sprite_.getTextureRect().width;
-        int h = sprite_.getTextureRect().height;
-
-        sprite_.setScale(b2_radius * 2.0f * scale / (1.0f * w), b2_radius * 2.0f * scale / (1.0f * h));
-
-        sprite_.setOrigin(w / 2.f, h / 2.f);
-    };
+    Bird(b2Body *body, TextureId texture, float b2_radius)
+        : Object(body, texture, SoundId::Bird, MaterialId::Bird, b2_radius, b2_radius){};
     void MakeSound()
     {
-        soundBuffer.loadFromFile("resources/sounds/bird.wav");
-        sound.setBuffer(soundBuffer);
-        sound.setVolume(5);
-        sound.play();
+        Resources::Get().PlaySound(sound_, 5);
     }
 
     void Throw()
@@ -41,6 +30,17 @@ public:
         }
     }
     virtual void UsePower(){};
+
+    int GetPowerLeft() const { return power_left_; }
+    bool IsPowerUsed() const { return power_used; }
+
+    // Puts back the throw and ability state saved by Level::CaptureState
+    void Restore(int power_left, bool ability_used, bool thrown)
+    {
+        power_left_ = power_left;
+        power_used = ability_used;
+        thrown_ = thrown;
+    }
     virtual char GetType() = 0;
     int TryToDestroy(float power)
     {
@@ -48,12 +48,8 @@ public:
     }
 
 protected:
-    const float bird_scale_ = 0.1f; // Maybe could be replaced by levels scale and bodys radius
-    sf::SoundBuffer soundBuffer;
-    sf::Sound sound;
-    int max_power_ = 20;
+    const static int max_power_ = 20;
     int power_left_ = 0;
-    b2Body *body_;
     bool power_used = false;
     bool thrown_ = false;
 };
@@ -61,14 +57,16 @@ protected:
 class BoomerangBird : public Bird
 {
 public:
-    BoomerangBird(b2Body *body, float b2_r) : Bird(body, "resources/images/bird.png", b2_r){};
+    BoomerangBird(b2Body *body, float b2_r) : Bird(body, TextureId::Bird, b2_r){};
     virtual void UsePower()
     {
         if (power_left_ > 0)
         {
             power_left_--;
-            body_->SetAngularVelocity(40);
-            body_->SetLinearVelocity(body_->GetLinearVelocity() - b2Vec2(0.5, 0.5));
+            // The body can be recreated when it moves between islands, so never keep it
+            b2Body *body = GetBody();
+            body->SetAngularVelocity(40);
+            body->SetLinearVelocity(body->GetLinearVelocity() - b2Vec2(0.5, 0.5));
         }
     };
     virtual char GetType() { return 'B'; };
@@ -77,13 +75,13 @@ public:
 class DroppingBird : public Bird
 {
 public:
-    DroppingBird(b2Body *body, float b2_r) : Bird(body, "resources/images/bird2.png", b2_r){};
+    DroppingBird(b2Body *body, float b2_r) : Bird(body, TextureId::Bird2, b2_r){};
     virtual void UsePower()
     {
         if (power_left_ > 0)
         {
             power_left_--;
-            body_->SetLinearVelocity(body_->GetLinearVelocity() - b2Vec2(0, 2));
+            GetBody()->SetLinearVelocity(GetBody()->GetLinearVelocity() - b2Vec2(0, 2));
         }
     };
     virtual char GetType() { return 'D'; };
@@ -92,13 +90,13 @@ public:
 class SpeedBird : public Bird
 {
 public:
-    SpeedBird(b2Body *body, float b2_r) : Bird(body, "resources/images/bird3.png", b2_r){};
+    SpeedBird(b2Body *body, float b2_r) : Bird(body, TextureId::Bird3, b2_r){};
     virtual void UsePower()
     {
         if (power_left_ >= max_power_ - 2)
         {
             power_left_--;
-            body_->SetLinearVelocity(body_->GetLinearVelocity() + body_->GetLinearVelocity());
+            GetBody()->SetLinearVelocity(GetBody()->GetLinearVelocity() + GetBody()->GetLinearVelocity());
         }
     };
     virtual char GetType() { return 'S'; };
@@ -28,6 +28,8 @@ const b2Vec2 gravity(0.0f, -9.8f);
 const float scale = 100.0f;
 const b2Vec2 bird_starting_position(3, 2.5f);
 const std::string file_suffix = "ab"; // ab as in Angry Birds
+const std::string cache_directory = "cache"; // Generated files (texture atlas etc.)
+const std::string font_file = "resources/fonts/Raleway-Medium.ttf";
 
 namespace utils
 {
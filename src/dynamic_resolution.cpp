@@ -0,0 +1,99 @@
+#include "dynamic_resolution.hpp"
+#include "converters.hpp"
+#include "memory_stats.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+    const float frame_budget = 1.0f / framerate;
+    const float over_budget = 0.9f * frame_budget;  // Drop the resolution above this
+    const float under_budget = 0.6f * frame_budget; // Raise it below this
+    const int calm_frames_needed = 30;              // Half a second under budget before raising
+    const float scale_down = 0.1f;
+    const float scale_up = 0.05f;
+}
+
+DynamicResolution::DynamicResolution(float min_scale) : min_scale_(min_scale)
+{
+}
+
+DynamicResolution::~DynamicResolution()
+{
+    memory_stats::Add(MemoryTag::Textures, -4LL * size_.x * size_.y);
+}
+
+bool DynamicResolution::Fit(sf::Vector2u size)
+{
+    if (failed_ || size == size_)
+    {
+        return !failed_;
+    }
+    memory_stats::Add(MemoryTag::Textures, -4LL * size_.x * size_.y);
+    size_ = sf::Vector2u();
+    if (!texture_.create(size.x, size.y))
+    {
+        std::cerr << "Dynamic resolution: failed to create a " << size.x << "x" << size.y << " texture" << std::endl;
+        failed_ = true;
+        return false;
+    }
+    texture_.setSmooth(true);
+    size_ = size;
+    memory_stats::Add(MemoryTag::Textures, 4LL * size_.x * size_.y);
+    return true;
+}
+
+sf::RenderTarget &DynamicResolution::Begin(sf::RenderWindow &window, const sf::View &view)
+{
+    offscreen_ = Fit(window.getSize());
+    if (!offscreen_)
+    {
+        window.setView(view);
+        return window;
+    }
+    // Same view squeezed into the top left corner
+    sf::View scaled(view);
+    sf::FloatRect viewport = view.getViewport();
+    scaled.setViewport(sf::FloatRect(viewport.left * scale_, viewport.top * scale_, viewport.width * scale_, viewport.height * scale_));
+    texture_.setView(scaled);
+    texture_.clear(sf::Color::Blue);
+    return texture_;
+}
+
+void DynamicResolution::End(sf::RenderWindow &window)
+{
+    if (!offscreen_)
+    {
+        return;
+    }
+    texture_.display();
+    int width = std::max(1, static_cast<int>(std::lround(size_.x * scale_)));
+    int height = std::max(1, static_cast<int>(std::lround(size_.y * scale_)));
+    sf::Sprite sprite(texture_.getTexture(), sf::IntRect(0, 0, width, height));
+    sprite.setScale(static_cast<float>(size_.x) / width, static_cast<float>(size_.y) / height);
+
+    sf::View view = window.getView();
+    window.setView(sf::View(sf::FloatRect(0, 0, static_cast<float>(size_.x), static_cast<float>(size_.y))));
+    window.draw(sprite, sf::BlendNone);
+    window.setView(view);
+}
+
+void DynamicResolution::Update(sf::Time frame_time)
+{
+    float seconds = frame_time.asSeconds();
+    if (seconds > over_budget)
+    {
+        scale_ = std::max(min_scale_, scale_ - scale_down);
+        calm_frames_ = 0;
+    }
+    else if (seconds < under_budget && ++calm_frames_ >= calm_frames_needed)
+    {
+        scale_ = std::min(1.0f, scale_ + scale_up);
+        calm_frames_ = 0;
+    }
+    else if (seconds >= under_budget)
+    {
+        calm_frames_ = 0;
+    }
+}
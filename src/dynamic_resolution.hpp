@@ -0,0 +1,45 @@
+#ifndef ANGRY_BIRDS_DYNAMIC_RESOLUTION
+#define ANGRY_BIRDS_DYNAMIC_RESOLUTION
+
+#include <SFML/Graphics.hpp>
+
+// Renders the world into an off-screen texture at a fraction of the window's
+// resolution and upscales it into the window. The fraction drops when frames
+// take too long and slowly recovers when there is time to spare. The texture is
+// always window sized, lower resolutions only use its top left corner, so
+// changing the scale never reallocates.
+class DynamicResolution
+{
+public:
+    explicit DynamicResolution(float min_scale = 0.5f);
+    ~DynamicResolution();
+
+    DynamicResolution(const DynamicResolution &) = delete;
+    DynamicResolution &operator=(const DynamicResolution &) = delete;
+
+    // Starts drawing the world with the given view. Returns the window itself
+    // if the off-screen texture can't be used.
+    sf::RenderTarget &Begin(sf::RenderWindow &window, const sf::View &view);
+
+    // Upscales what was drawn since Begin into the window
+    void End(sf::RenderWindow &window);
+
+    // Adapts the scale to how long the last frame's work took
+    void Update(sf::Time frame_time);
+
+    float GetScale() const { return scale_; }
+
+private:
+    // (Re)creates the texture when the window size changes
+    bool Fit(sf::Vector2u size);
+
+    float min_scale_;
+    float scale_ = 1.0f;
+    int calm_frames_ = 0; // Frames in a row well within the budget
+    sf::RenderTexture texture_;
+    sf::Vector2u size_;
+    bool failed_ = false;    // Creating the texture failed, draw straight to the window
+    bool offscreen_ = false; // Is the current frame drawn into the texture
+};
+
+#endif // ANGRY_BIRDS_DYNAMIC_RESOLUTION
@@ -0,0 +1,35 @@
+#include "fast_forward.hpp"
+#include "converters.hpp"
+#include <algorithm>
+
+namespace
+{
+    // Stepping may use half of the frame, the rest is left for drawing and input
+    const float step_budget = 0.5f / framerate;
+    const float smoothing = 0.2f; // Weight of the newest measurement in the running average
+}
+
+FastForward::FastForward(int max_speed) : max_speed_(std::max(1, max_speed))
+{
+}
+
+void FastForward::Record(int steps, sf::Time elapsed)
+{
+    if (steps <= 0)
+    {
+        return;
+    }
+    float per_step = elapsed.asSeconds() / steps;
+    step_seconds_ = step_seconds_ == 0 ? per_step : step_seconds_ + smoothing * (per_step - step_seconds_);
+
+    // Speed up one step at a time so a single fast frame doesn't cause a stutter,
+    // but slow down at once when the budget is exceeded
+    int affordable = step_seconds_ > 0 ? static_cast<int>(step_budget / step_seconds_) : max_speed_;
+    affordable = std::max(1, std::min(max_speed_, affordable));
+    speed_ = affordable < speed_ ? affordable : std::min(speed_ + 1, affordable);
+}
+
+void FastForward::Reset()
+{
+    speed_ = 1;
+}
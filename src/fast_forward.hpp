@@ -0,0 +1,30 @@
+#ifndef ANGRY_BIRDS_FAST_FORWARD
+#define ANGRY_BIRDS_FAST_FORWARD
+
+#include <SFML/System.hpp>
+
+// Decides how many fixed time steps to run per rendered frame while fast-forwarding.
+// Every step is the same Level::Step as at normal speed so the results don't change,
+// only the in-between states are never drawn. The speed-up follows the measured cost
+// of a step so that stepping stays within its share of the frame.
+class FastForward
+{
+public:
+    explicit FastForward(int max_speed = 8);
+
+    // Steps to run during the next frame, at least 1
+    int GetSpeed() const { return speed_; }
+
+    // Reports how long the last frame's steps took and adapts the speed to it
+    void Record(int steps, sf::Time elapsed);
+
+    // Back to normal speed, e.g. when a new throw starts
+    void Reset();
+
+private:
+    int max_speed_;
+    int speed_ = 1;
+    float step_seconds_ = 0; // Running average of the cost of one step
+};
+
+#endif // ANGRY_BIRDS_FAST_FORWARD
@@ -0,0 +1,148 @@
+#include "frame_pacer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+    const size_t interval_history = 600; // Ten seconds at 60 fps
+    const double missed_factor = 1.5;   // An interval this many periods long is a missed deadline
+
+    // Sleeps overshoot by up to a scheduler tick, the last part of the wait is spun instead
+    const std::chrono::microseconds spin_margin(2000);
+
+    const char *mode_names[] = {"vsync", "precise", "uncapped"};
+}
+
+FramePacer::FramePacer(sf::Window &window, PacingMode mode, int target_fps)
+    : window_(window),
+      period_(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / target_fps))),
+      intervals_ms_(interval_history, 0.0f)
+{
+    SetMode(mode);
+}
+
+void FramePacer::SetMode(PacingMode mode)
+{
+    mode_ = mode;
+    // Pacing is done here, never by SFML
+    window_.setFramerateLimit(0);
+    window_.setVerticalSyncEnabled(mode == PacingMode::VSync);
+    deadline_ = Clock::now() + period_;
+    skip_next_ = true;
+}
+
+void FramePacer::WaitUntil(Clock::time_point deadline)
+{
+    Clock::time_point now = Clock::now();
+    if (deadline - now > spin_margin)
+    {
+        std::this_thread::sleep_for(deadline - now - spin_margin);
+    }
+    while (Clock::now() < deadline)
+    {
+    }
+}
+
+void FramePacer::FrameDone()
+{
+    if (mode_ == PacingMode::Precise)
+    {
+        Clock::time_point now = Clock::now();
+        if (now > deadline_ + period_)
+        {
+            // Too late to catch up without a burst of frames, start over from now
+            deadline_ = now;
+        }
+        else
+        {
+            WaitUntil(deadline_);
+        }
+        deadline_ += period_;
+    }
+
+    Clock::time_point present = Clock::now();
+    if (has_last_present_ && !skip_next_)
+    {
+        float ms = std::chrono::duration<float, std::milli>(present - last_present_).count();
+        intervals_ms_[next_interval_] = ms;
+        next_interval_ = (next_interval_ + 1) % intervals_ms_.size();
+        total_frames_++;
+        if (mode_ != PacingMode::Uncapped && ms > missed_factor * std::chrono::duration<float, std::milli>(period_).count())
+        {
+            total_missed_++;
+        }
+    }
+    last_present_ = present;
+    has_last_present_ = true;
+    skip_next_ = false;
+}
+
+FramePacer::Stats FramePacer::GetStats() const
+{
+    Stats stats;
+    stats.frames = std::min(total_frames_, intervals_ms_.size());
+    if (stats.frames == 0)
+    {
+        return stats;
+    }
+    double period_ms = std::chrono::duration<double, std::milli>(period_).count();
+    double sum = 0;
+    stats.min_ms = intervals_ms_[0];
+    for (size_t i = 0; i < stats.frames; i++)
+    {
+        double ms = intervals_ms_[i];
+        sum += ms;
+        stats.min_ms = std::min(stats.min_ms, ms);
+        stats.max_ms = std::max(stats.max_ms, ms);
+        if (mode_ != PacingMode::Uncapped && ms > missed_factor * period_ms)
+        {
+            stats.missed++;
+        }
+    }
+    stats.mean_ms = sum / stats.frames;
+    double variance = 0;
+    for (size_t i = 0; i < stats.frames; i++)
+    {
+        variance += (intervals_ms_[i] - stats.mean_ms) * (intervals_ms_[i] - stats.mean_ms);
+    }
+    stats.stddev_ms = std::sqrt(variance / stats.frames);
+    return stats;
+}
+
+std::string FramePacer::Summary() const
+{
+    Stats stats = GetStats();
+    std::stringstream text;
+    text.precision(2);
+    text << std::fixed << "Frames (" << ModeName(mode_) << "): " << stats.mean_ms << " ms, sd " << stats.stddev_ms
+         << " ms, " << stats.missed << " missed" << std::endl;
+    return text.str();
+}
+
+void FramePacer::PrintReport(std::ostream &output) const
+{
+    Stats stats = GetStats();
+    output << "Frame pacing (" << ModeName(mode_) << "), last " << stats.frames << " frames: mean " << stats.mean_ms
+           << " ms, sd " << stats.stddev_ms << " ms, min " << stats.min_ms << " ms, max " << stats.max_ms
+           << " ms, " << stats.missed << " missed; " << total_missed_ << " of " << total_frames_ << " missed in total" << std::endl;
+}
+
+const char *FramePacer::ModeName(PacingMode mode)
+{
+    return mode_names[static_cast<int>(mode)];
+}
+
+bool FramePacer::ParseMode(const std::string &name, PacingMode &mode)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        if (name == mode_names[i])
+        {
+            mode = static_cast<PacingMode>(i);
+            return true;
+        }
+    }
+    return false;
+}
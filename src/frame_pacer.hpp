@@ -0,0 +1,77 @@
+#ifndef ANGRY_BIRDS_FRAME_PACER
+#define ANGRY_BIRDS_FRAME_PACER
+
+#include <SFML/Window.hpp>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+enum class PacingMode
+{
+    VSync,   // The driver waits for the display's refresh
+    Precise, // Sleeps until shortly before the deadline and spins the rest
+    Uncapped // No waiting at all, for throughput testing
+};
+
+// Paces frames to the target rate and measures the time between presents.
+// sf::Window::setFramerateLimit only sleeps, and sleeps overshoot by up to a
+// scheduler tick, so frame times come out uneven.
+class FramePacer
+{
+public:
+    FramePacer(sf::Window &window, PacingMode mode, int target_fps);
+
+    void SetMode(PacingMode mode);
+    PacingMode GetMode() const { return mode_; }
+
+    // Call right after display(). Waits for the next deadline when pacing
+    // precisely and records the interval since the previous present.
+    void FrameDone();
+
+    // The next interval isn't recorded, for when the loop idled waiting for input on purpose
+    void Skip() { skip_next_ = true; }
+
+    struct Stats
+    {
+        size_t frames = 0;
+        double mean_ms = 0;
+        double stddev_ms = 0;
+        double min_ms = 0;
+        double max_ms = 0;
+        size_t missed = 0; // Frames that took more than one and a half periods
+    };
+
+    // Over the last few seconds of recorded frames
+    Stats GetStats() const;
+
+    // One line for the debug overlay
+    std::string Summary() const;
+
+    void PrintReport(std::ostream &output) const;
+
+    static const char *ModeName(PacingMode mode);
+
+    // Parses vsync, precise or uncapped, returns false for anything else
+    static bool ParseMode(const std::string &name, PacingMode &mode);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    void WaitUntil(Clock::time_point deadline);
+
+    sf::Window &window_;
+    PacingMode mode_;
+    Clock::duration period_;
+    Clock::time_point deadline_;
+    Clock::time_point last_present_;
+    bool has_last_present_ = false;
+    bool skip_next_ = false;
+
+    std::vector<float> intervals_ms_; // Ring buffer of the latest intervals
+    size_t next_interval_ = 0;
+    size_t total_frames_ = 0;
+    size_t total_missed_ = 0;
+};
+
+#endif // ANGRY_BIRDS_FRAME_PACER
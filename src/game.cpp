@@ -1,9 +1,76 @@
 #include "game.hpp"
 #include <string>
+#include <iomanip>
 
-Game::Game() : window_(sf::VideoMode(viewwidth, viewheight), "Angry Birds")
+namespace
+{
+    const sf::Time idle_poll_interval = sf::milliseconds(10);
+    const sf::Time idle_redraw_interval = sf::seconds(1); // Redraw now and then even when idle
+    const std::string background_file = "resources/images/bg_img.jpeg";
+
+    // Area the game view can be scrolled to, covered by the static layer. Wide levels reach
+    // further right. Following a bird flying higher than this falls back to drawing the
+    // background directly.
+    sf::FloatRect StaticLayerBounds(float world_right)
+    {
+        float right = std::max(viewwidth / 2.0f + 1500, world_right * scale) + viewwidth / 2.0f + 100;
+        return sf::FloatRect(-100, -1600, right + 100, 2600);
+    }
+
+    // A thrown bird slower than this (m/s) has stopped and the rest is fast-forwarded
+    const float bird_rest_speed = 0.5f;
+
+    // Finds the build-time compiled version of a level file by its content hash.
+    // The level is either embedded in the executable or in the build's level directory.
+    bool LoadCompiledLevel(const std::string &text, LevelAsset &asset)
+    {
+        uint64_t hash = level_asset::ContentHash(text);
+        const char *data;
+        size_t size;
+        bool loaded = false;
+        if (level_asset::FindEmbedded(hash, data, size))
+        {
+            loaded = level_asset::ReadBinary(data, size, asset);
+        }
+#ifdef AB_LEVEL_ASSET_DIR
+        else
+        {
+            std::stringstream filename;
+            filename << AB_LEVEL_ASSET_DIR << "/" << std::hex << std::setw(16) << std::setfill('0') << hash << ".abl";
+            std::ifstream file(filename.str(), std::ios::binary);
+            std::string blob((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            loaded = file.is_open() && level_asset::ReadBinary(blob.data(), blob.size(), asset);
+        }
+#endif
+        if (!loaded || asset.source_hash != hash)
+        {
+            return false;
+        }
+
+        // High scores change while playing so they are always read from the level file
+        std::stringstream lines(text);
+        std::string line;
+        std::getline(lines, line);
+        std::getline(lines, line);
+        asset.high_scores = level_asset::ParseHighScores(line);
+        return true;
+    }
+
+    // Long tracks are streamed from disk in small chunks instead of being decoded into memory.
+    // A compressed .ogg version of the track is preferred when one exists.
+    bool OpenMusic(sf::Music &music, const std::string &path_without_suffix)
+    {
+        if (utils::FileSize(path_without_suffix + ".ogg") > 0)
+        {
+            return music.openFromFile(path_without_suffix + ".ogg");
+        }
+        return music.openFromFile(path_without_suffix + ".wav");
+    }
+}
+
+Game::Game(PacingMode pacing, PhysicsBackend physics)
+    : window_(sf::VideoMode(viewwidth, viewheight), "Angry Birds"), pacer_(window_, pacing, framerate), physics_(physics)
 {
-    window_.setFramerateLimit(framerate);
 }
 
 void Game::LoadLevel(std::string filename)
@@ -16,9 +83,67 @@ void Game::LoadLevel(std::string filename)
     }
     else
     {
+        memory_stats::Snapshot before = memory_stats::Take();
+        // Leaving a level for another one ends its attempt unfinished
+        telemetry_.EndAttempt(current_level_.GetScore(), current_level_.GetStars(), false, false);
         current_level_file_name_ = filename;
-        current_level_ = Level(file);
+        std::stringstream text;
+        text << file.rdbuf();
+        LevelAsset asset;
+        if (LoadCompiledLevel(text.str(), asset))
+        {
+            current_level_ = Level(asset, physics_);
+        }
+        else
+        {
+            // Not compiled at build time (edited after building), parse the text instead
+            current_level_ = Level(text, physics_);
+        }
+        static_layer_.Clear();
+        rewind_.Clear();
+        telemetry_.BeginAttempt(level_asset::ContentHash(text.str()), current_level_.GetLevelNumber());
+        memory_stats::PrintDelta(std::cout, "loading " + filename, before);
+    }
+}
+
+bool Game::ResumeLevel()
+{
+    std::string level_file;
+    std::string save_file = Autosaver::LatestSave(level_file);
+    std::ifstream save(save_file);
+    std::ifstream level(level_file);
+    if (save_file.empty() || !save.is_open() || !level.is_open())
+    {
+        std::cerr << "No autosave to resume" << std::endl;
+        return false;
+    }
+    std::vector<std::string> errors;
+    LevelAsset asset = level_asset::Parse(save, errors);
+    for (const auto &error : errors)
+    {
+        std::cerr << "Reading autosave " << save_file << ": " << error << std::endl;
     }
+    if (!errors.empty())
+    {
+        return false;
+    }
+
+    // The level file is still the one played, high scores are saved into it and retries reload it
+    std::stringstream text;
+    text << level.rdbuf();
+    std::string line;
+    std::getline(text, line);
+    std::getline(text, line);
+    asset.high_scores = level_asset::ParseHighScores(line);
+
+    victory_achieved_ = 0;
+    telemetry_.EndAttempt(current_level_.GetScore(), current_level_.GetStars(), false, false);
+    current_level_file_name_ = level_file;
+    current_level_ = Level(asset, physics_);
+    static_layer_.Clear();
+    rewind_.Clear();
+    telemetry_.BeginAttempt(level_asset::ContentHash(text.str()), current_level_.GetLevelNumber());
+    return true;
 }
 
 void Game::LoadIcon()
@@ -29,47 +154,126 @@ void Game::LoadIcon()
     window_.setIcon(size.x, size.y, icon.getPixelsPtr());
 }
 
+void Game::DrawStaticLayer(sf::RenderTarget &target)
+{
+    if (static_layer_.IsEmpty() || static_layer_changes_ != current_level_.GetStaticChanges())
+    {
+        if (static_layer_.IsEmpty())
+        {
+            static_layer_.Reset(StaticLayerBounds(current_level_.GetWorldRight()), [this](sf::RenderTarget &target)
+                                {
+                                    target.draw(bg_sprite_);
+                                    current_level_.DrawStatic(target); });
+        }
+        else
+        {
+            static_layer_.Invalidate();
+        }
+        // Tiles with nothing but empty space in them are never baked
+        sf::FloatRect background = bg_sprite_.getGlobalBounds();
+        sf::FloatRect bodies = current_level_.GetStaticBounds();
+        float left = std::min(background.left, bodies.left);
+        float top = std::min(background.top, bodies.top);
+        static_layer_.SetContent(sf::FloatRect(left, top, std::max(background.left + background.width, bodies.left + bodies.width) - left,
+                                               std::max(background.top + background.height, bodies.top + bodies.height) - top));
+        static_layer_changes_ = current_level_.GetStaticChanges();
+    }
+    // Static bodies destroyed or streamed in and out only touch the tiles around them
+    sf::FloatRect updated;
+    if (current_level_.TakeStaticUpdate(updated))
+    {
+        static_layer_.Invalidate(updated);
+    }
+    bool covered = static_layer_.Covers(target.getView());
+    if (!covered)
+    {
+        target.draw(bg_sprite_);
+    }
+    static_layer_.Draw(target);
+    if (!covered)
+    {
+        // Static bodies of wide levels outside the baked area
+        current_level_.DrawStatic(target);
+    }
+}
+
 void Game::SaveLevel()
 {
-    std::ofstream file = utils::OpenFileSafe("testi");
-    current_level_.SaveState(file);
+    autosaver_.Save(current_level_.Snapshot(), current_level_file_name_);
+}
+
+void Game::LoadAssets()
+{
+    AssetLoader &loader = AssetLoader::Get();
+    loader.Queue(background_file, AssetKind::Texture);
+    Menu::Preload();
+    TextureAtlas::Preload();
+    Resources::Preload();
+
+    // Nothing but plain shapes until the assets are in
+    sf::RectangleShape frame(sf::Vector2f(viewwidth / 2.0f, 40));
+    frame.setPosition(viewwidth / 4.0f, viewheight / 2.0f - 20);
+    frame.setFillColor(sf::Color::Transparent);
+    frame.setOutlineColor(sf::Color::White);
+    frame.setOutlineThickness(3.0f);
+    sf::RectangleShape bar(frame.getSize());
+    bar.setPosition(frame.getPosition());
+    while (window_.isOpen() && !loader.IsDone())
+    {
+        sf::Event event;
+        while (window_.pollEvent(event))
+        {
+            if (event.type == sf::Event::EventType::Closed)
+            {
+                window_.close();
+            }
+        }
+        loader.Update();
+        bar.setScale(loader.GetProgress(), 1);
+        window_.clear(sf::Color::Blue);
+        window_.draw(frame);
+        window_.draw(bar);
+        window_.display();
+        pacer_.FrameDone();
+    }
+    loader.PrintReport(std::cout);
 }
 
 void Game::Start()
 {
+    LoadAssets();
     victory_achieved_ = 0;
-    sf::SoundBuffer victory_sound_buffer;
-    victory_sound_buffer.loadFromFile("resources/sounds/victory_royale.wav");
-    sf::Sound victory_sound;
-    victory_sound.setBuffer(victory_sound_buffer);
+    sf::Music victory_sound;
+    OpenMusic(victory_sound, "resources/sounds/victory_royale");
     victory_sound.setVolume(20);
 
-    sf::SoundBuffer bg_music_buffer;
-    bg_music_buffer.loadFromFile("resources/sounds/angry_birds_bg_music.wav");
-    sf::Sound bg_music;
-    bg_music.setBuffer(bg_music_buffer);
+    sf::Music bg_music;
+    OpenMusic(bg_music, "resources/sounds/angry_birds_bg_music");
     bg_music.setVolume(1);
     bg_music.setLoop(true);
     bg_music.play();
 
-    background_texture_.loadFromFile("./resources/images/bg_img.jpeg");
-    background_texture_.setRepeated(true);
-    bg_sprite_.setTexture(background_texture_);
+    sf::Texture &background_texture = AssetLoader::Get().GetTexture(background_file);
+    background_texture.setRepeated(true);
+    bg_sprite_.setTexture(background_texture);
     bg_sprite_.setTextureRect({0, 0, viewwidth * 10, viewheight * 10});
     bg_sprite_.setScale(1, 3);
-    bg_sprite_.setOrigin(0, 2 * background_texture_.getSize().y - 450); // background_texture_.getSize().y - viewheight - 25
+    bg_sprite_.setOrigin(0, 2 * background_texture.getSize().y - 450); // background_texture.getSize().y - viewheight - 25
 
     sf::View game_view(window_.getDefaultView());
 
     MainMenu main_menu = MainMenu();
+    std::string saved_level;
+    main_menu.ShowContinue(!Autosaver::LatestSave(saved_level).empty());
 
-    LevelSelector level_selector = LevelSelector();
+    LevelSelector level_selector;
 
     PauseMenu pause_menu = PauseMenu();
 
     LevelEndMenu end_screen = LevelEndMenu(0);
 
-    HighScores high_scores = HighScores(current_level_);
+    HighScores high_scores;
+    high_scores.SetScores(current_level_.GetScores());
     high_scores.Close();
 
     auto IsMenuOpen = [&]()
@@ -77,8 +281,7 @@ void Game::Start()
         return main_menu.IsOpen() || level_selector.IsOpen() || pause_menu.IsOpen() || end_screen.IsOpen() || high_scores.IsOpen();
     };
 
-    sf::Font font;
-    font.loadFromFile("resources/fonts/Raleway-Medium.ttf");
+    const sf::Font &font = AssetLoader::Get().GetFont(font_file);
     sf::Text score;
     score.setFont(font);
     score.setFillColor(sf::Color::White);
@@ -86,6 +289,19 @@ void Game::Start()
     score.setOutlineThickness(3.0f);
     score.setString(std::string("Score: ") + std::to_string(current_level_.GetScore()));
     score.setCharacterSize(40);
+    sf::Text memory_text;
+    memory_text.setFont(font);
+    memory_text.setFillColor(sf::Color::White);
+    memory_text.setOutlineColor(sf::Color::Black);
+    memory_text.setOutlineThickness(2.0f);
+    memory_text.setCharacterSize(24);
+    memory_text.setPosition(10, 110);
+    sf::Text speed_text;
+    speed_text.setFont(font);
+    speed_text.setFillColor(sf::Color::White);
+    speed_text.setOutlineColor(sf::Color::Black);
+    speed_text.setOutlineThickness(3.0f);
+    speed_text.setCharacterSize(40);
     sf::Text high_score;
     high_score.setFont(font);
     high_score.setFillColor(sf::Color::White);
@@ -93,21 +309,16 @@ void Game::Start()
     high_score.setOutlineThickness(3.0f);
     high_score.setString(std::string("High Score: ") + std::to_string(std::get<1>(current_level_.GetHighScore())));
     high_score.setCharacterSize(40);
+    const TextureAtlas &atlas = TextureAtlas::Get();
     sf::RectangleShape pause(sf::Vector2f(100.0f, 100.0f));
-    sf::Texture pauseImage;
-    pauseImage.loadFromFile("resources/images/pause.png");
-    pause.setTexture(&pauseImage);
+    atlas.Apply(pause, "pause");
     sf::RectangleShape obj_images[4];
-    sf::Texture obj_textures[4];
-    obj_textures[0].loadFromFile("resources/images/bird.png");
-    obj_textures[1].loadFromFile("resources/images/bird2.png");
-    obj_textures[2].loadFromFile("resources/images/bird3.png");
-    obj_textures[3].loadFromFile("resources/images/pig.png");
+    const std::string obj_image_names[4] = {"bird", "bird2", "bird3", "pig"};
     sf::Text obj_indicators[4];
     for (int i = 0; i < 4; i++)
     {
         obj_images[i].setSize(sf::Vector2f(100.0f, 100.0f));
-        obj_images[i].setTexture(&obj_textures[i]);
+        atlas.Apply(obj_images[i], obj_image_names[i]);
         obj_indicators[i].setFont(font);
         obj_indicators[i].setFillColor(sf::Color::White);
         obj_indicators[i].setCharacterSize(20);
@@ -119,11 +330,22 @@ void Game::Start()
     bool has_just_settled = settled; // Has the world settled on the previous simulation step
     float direction = 0;             // Direction of the aiming arrow in degrees
     float power = 0;                 // Power of the aiming arrow (0-100)
+    bool redraw = true; // Does the next frame have to be drawn even without new input
+    sf::Clock frame_clock; // Time spent on the current frame, without idling or pacing
+    int prev_open_menus = -1;
     while (window_.isOpen())
     {
-        sf::Vector2f mouse_position = window_.mapPixelToCoords(sf::Mouse::getPosition(window_));
         sf::Event event;
-        while (window_.pollEvent(event))
+        bool has_event = window_.pollEvent(event);
+        if (!has_event && !redraw)
+        {
+            // Nothing is animating, sleep until there is input or the idle redraw interval passes
+            has_event = WaitEvent(event, idle_redraw_interval);
+            pacer_.Skip(); // Idling isn't a missed frame
+        }
+        frame_clock.restart();
+        sf::Vector2f mouse_position = window_.mapPixelToCoords(sf::Mouse::getPosition(window_));
+        for (; has_event; has_event = window_.pollEvent(event))
         {
             switch (event.type)
             {
@@ -148,12 +370,17 @@ void Game::Start()
                     }
                     else if (settled && !IsMenuOpen() && power != 0)
                     {
-                        float x = cos(utils::DegreesToRadians(direction)) * power / 20;
-                        float y = sin(utils::DegreesToRadians(direction)) * power / 20;
-                        current_level_.ThrowBird(0, b2Vec2(x, y));
+                        current_level_.ThrowBird(0, Level::ThrowImpulse(direction, power));
+                        telemetry_.RecordThrow();
                     }
                 }
                 break;
+            case sf::Event::EventType::MouseWheelScrolled:
+                if (level_selector.IsOpen() && !main_menu.IsOpen())
+                {
+                    level_selector.Scroll(event.mouseWheelScroll.delta > 0 ? -1 : 1);
+                }
+                break;
             case sf::Event::EventType::Resized:
             {
                 float width = static_cast<float>(event.size.width);
@@ -183,6 +410,8 @@ void Game::Start()
                 {
                     main_menu.ChangeNickname(event.text.unicode);
                 }
+                // event.key is not set for typed text, falling through would read the character as a key code
+                break;
             }
             case sf::Event::EventType::KeyPressed:
 
@@ -199,18 +428,39 @@ void Game::Start()
                     break;
 
                 case sf::Keyboard::Left:
-                    if (settled && game_view.getCenter().x > window_.getDefaultView().getCenter().x) // Bounded from left
+                    if (level_selector.IsOpen() && !main_menu.IsOpen())
+                        level_selector.Scroll(-1);
+                    else if (settled && game_view.getCenter().x > window_.getDefaultView().getCenter().x) // Bounded from left
                         game_view.move(-10, 0);
                     break;
 
                 case sf::Keyboard::Right:
-                    if (settled && game_view.getCenter().x < window_.getDefaultView().getCenter().x + 1500) // Bounded from right
+                    if (level_selector.IsOpen() && !main_menu.IsOpen())
+                        level_selector.Scroll(1);
+                    else if (settled && game_view.getCenter().x < std::max(window_.getDefaultView().getCenter().x + 1500, current_level_.GetWorldRight() * scale)) // Bounded from right, wide levels can be panned to the end
                         game_view.move(10, 0);
                     break;
                 case sf::Keyboard::Space:
                     if (settled) // Move the view back to its original position
                         game_view.move(window_.getDefaultView().getCenter().x - game_view.getCenter().x, window_.getDefaultView().getCenter().y - game_view.getCenter().y);
                     break;
+                case sf::Keyboard::F3:
+                    show_memory_ = !show_memory_;
+                    break;
+                case sf::Keyboard::F4:
+                    // Cycles vsync, precise and uncapped pacing
+                    pacer_.SetMode(static_cast<PacingMode>((static_cast<int>(pacer_.GetMode()) + 1) % 3));
+                    break;
+                case sf::Keyboard::F:
+                    turbo_ = !turbo_;
+                    break;
+                case sf::Keyboard::BackSpace:
+                    // Steps back to the snapshot before the newest one, holding it keeps rewinding
+                    if (!IsMenuOpen() && rewind_.GetCount() > 0 && rewind_.Restore(current_level_, rewind_.GetCount() > 1 ? rewind_.GetCount() - 2 : 0))
+                    {
+                        settled = false;
+                    }
+                    break;
                 case sf::Keyboard::Escape:
                     if (level_selector.IsOpen())
                     {
@@ -231,27 +481,23 @@ void Game::Start()
             }
         }
         window_.clear(sf::Color::Blue);
-        window_.draw(bg_sprite_);
+        bool drew_world = false;
+        if (IsMenuOpen() && !end_screen.IsOpen())
+        {
+            window_.draw(bg_sprite_);
+        }
         if (high_scores.IsOpen())
         {
-            high_scores.SetLevel(current_level_);
+            high_scores.SetScores(current_level_.GetScores());
             if (sf::Mouse::isButtonPressed(sf::Mouse::Left))
             {
                 if (mouse_position.x >= 7 && mouse_position.x <= 183 && mouse_position.y >= 120 && mouse_position.y <= 180)
                 {
                     high_scores.Close();
                 }
-                else if (mouse_position.x >= 1200 && mouse_position.x <= 1300 && mouse_position.y >= 300 && mouse_position.y <= 360)
+                else if (!high_scores.LevelAt(mouse_position).empty())
                 {
-                    LoadLevel("resources/levels/level1.ab");
-                }
-                else if (mouse_position.x >= 1200 && mouse_position.x <= 1300 && mouse_position.y >= 400 && mouse_position.y <= 460)
-                {
-                    LoadLevel("resources/levels/level2.ab");
-                }
-                else if (mouse_position.x >= 1200 && mouse_position.x <= 1300 && mouse_position.y >= 500 && mouse_position.y <= 560)
-                {
-                    LoadLevel("resources/levels/level3.ab");
+                    LoadLevel(high_scores.LevelAt(mouse_position));
                 }
             }
             high_scores.Draw(window_);
@@ -262,9 +508,26 @@ void Game::Start()
             if (sf::Mouse::isButtonPressed(sf::Mouse::Left))
             {
 
-                if (mouse_position.x >= 1006 && mouse_position.x <= 1160 && mouse_position.y >= 220 && mouse_position.y <= 300)
+                if (main_menu.IsContinueShown() && mouse_position.x >= 1006 && mouse_position.x <= 1330 && mouse_position.y >= 120 && mouse_position.y <= 200)
+                {
+                    // Resume the attempt the last autosave was made in
+                    if (ResumeLevel())
+                    {
+                        end_screen.SetLevel(current_level_.GetLevelNumber());
+                        pause_menu.Close();
+                        end_screen.Close();
+                        main_menu.Close();
+                        level_selector.Close();
+                    }
+                    else
+                    {
+                        main_menu.ShowContinue(false);
+                    }
+                }
+                else if (mouse_position.x >= 1006 && mouse_position.x <= 1160 && mouse_position.y >= 220 && mouse_position.y <= 300)
                 {
                     main_menu.Close();
+                    level_selector.Refresh();
                 }
                 else if (mouse_position.x >= 1007 && mouse_position.x <= 1448 && mouse_position.y >= 320 && mouse_position.y <= 400)
                 {
@@ -286,26 +549,10 @@ void Game::Start()
                     main_menu.Open();
                     level_selector.Close();
                 }
-                else if (mouse_position.x >= 100 && mouse_position.x <= 400 && mouse_position.y >= 400 && mouse_position.y <= 680)
-                {
-                    LoadLevel("resources/levels/level1.ab");
-                    end_screen.SetLevel(1);
-                    pause_menu.Close();
-                    end_screen.Close();
-                    level_selector.Close();
-                }
-                else if (mouse_position.x >= 600 && mouse_position.x <= 900 && mouse_position.y >= 400 && mouse_position.y <= 680)
-                {
-                    LoadLevel("resources/levels/level2.ab");
-                    end_screen.SetLevel(2);
-                    pause_menu.Close();
-                    end_screen.Close();
-                    level_selector.Close();
-                }
-                else if (mouse_position.x >= 1100 && mouse_position.x <= 1500 && mouse_position.y >= 400 && mouse_position.y <= 680)
+                else if (!level_selector.LevelAt(mouse_position).empty())
                 {
-                    LoadLevel("resources/levels/level3.ab");
-                    end_screen.SetLevel(3);
+                    LoadLevel(level_selector.LevelAt(mouse_position));
+                    end_screen.SetLevel(current_level_.GetLevelNumber());
                     pause_menu.Close();
                     end_screen.Close();
                     level_selector.Close();
@@ -332,7 +579,8 @@ void Game::Start()
         {
             if (sf::Mouse::isButtonPressed(sf::Mouse::Left))
             {
-                if (current_level_.GetLevelNumber() == 3)
+                const LevelInfo *next_level = LevelCatalog::Get().Next(current_level_.GetLevelNumber());
+                if (next_level == nullptr)
                 {
                     if (mouse_position.x >= 600 && mouse_position.x <= 775 && mouse_position.y >= 530 && mouse_position.y <= 645)
                     {
@@ -341,8 +589,7 @@ void Game::Start()
                     }
                     else if (mouse_position.x >= 864 && mouse_position.x <= 1025 && mouse_position.y >= 520 && mouse_position.y <= 645)
                     {
-                        //  int next_level = std::min(current_level_.GetLevelNumber() + 1, 3);
-                        LoadLevel("resources/levels/level" + std::to_string(current_level_.GetLevelNumber()) + ".ab");
+                        LoadLevel(current_level_file_name_);
                         end_screen.SetLevel(current_level_.GetLevelNumber());
                         end_screen.Close();
                     }
@@ -356,14 +603,13 @@ void Game::Start()
                     }
                     else if (mouse_position.x >= 925 && mouse_position.x <= 1080 && mouse_position.y >= 515 && mouse_position.y <= 635)
                     {
-                        int next_level = current_level_.GetLevelNumber() + 1;
-                        LoadLevel("resources/levels/level" + std::to_string(next_level) + ".ab");
-                        end_screen.SetLevel(next_level);
+                        LoadLevel(next_level->path);
+                        end_screen.SetLevel(current_level_.GetLevelNumber());
                         end_screen.Close();
                     }
                     else if (mouse_position.x >= 715 && mouse_position.x <= 879 && mouse_position.y >= 515 && mouse_position.y <= 640)
                     {
-                        LoadLevel("resources/levels/level" + std::to_string(current_level_.GetLevelNumber()) + ".ab");
+                        LoadLevel(current_level_file_name_);
                         end_screen.SetLevel(current_level_.GetLevelNumber());
                         end_screen.Close();
                     }
@@ -371,19 +617,19 @@ void Game::Start()
             }
             game_view = window_.getDefaultView();
             window_.setView(game_view);
+            DrawStaticLayer(window_);
             score.setPosition(window_.mapPixelToCoords(sf::Vector2i(window_.getSize().x * 0.7, 0)));
             score.setString(std::string("Score: ") + std::to_string(current_level_.GetScore()));
             high_score.setPosition(window_.mapPixelToCoords(sf::Vector2i(window_.getSize().x * 0.7, 40)));
             high_score.setString(std::string("High Score: ") + std::to_string(std::get<1>(current_level_.GetHighScore())));
             window_.draw(score);
             window_.draw(high_score);
-            current_level_.DrawLevel(window_);
+            current_level_.Draw(window_);
             end_screen.Draw(window_);
         }
         else
         {
             window_.setView(game_view);
-            current_level_.GetBird()->UsePower();
 
             sf::Vector2f bird_position = utils::B2ToSfCoords(current_level_.GetBird()->GetBody()->GetPosition());
             sf::Vector2f default_center = window_.getDefaultView().getCenter();
@@ -392,17 +638,42 @@ void Game::Start()
             if (!settled)
             {
                 // Used std min for the y since sfml coordinates are from top left downwards
-                game_view.setCenter(std::min(std::max(bird_position.x, window_.getDefaultView().getCenter().x), viewwidth * 1.f), std::min(bird_position.y, default_center.y));
+                float right_limit = std::max(viewwidth * 1.f, current_level_.GetWorldRight() * scale);
+                game_view.setCenter(std::min(std::max(bird_position.x, window_.getDefaultView().getCenter().x), right_limit), std::min(bird_position.y, default_center.y));
             }
 
-            current_level_.GetWorld()
-                ->Step(time_step, velocity_iterations, position_iterations);
+            // Keeps the chunks in view loaded
+            float view_left = (game_view.getCenter().x - game_view.getSize().x / 2) / scale;
+            current_level_.SetFocus(view_left, view_left + game_view.getSize().x / scale);
+
             bool prev_settled = settled;
 
-            settled = !current_level_.DrawLevel(window_);
+            // Fast-forward runs several steps and draws only the last of them
+            Bird *bird = current_level_.GetBird();
+            bool fast = !settled && bird->IsThrown() && (turbo_ || bird->GetBody()->GetLinearVelocity().Length() < bird_rest_speed);
+            int steps = 0;
+            sf::Clock step_clock;
+            settled = !current_level_.Advance(fast ? fast_forward_.GetSpeed() : 1, &steps);
+            sf::Time step_time = step_clock.getElapsedTime();
+            telemetry_.RecordSteps(steps, step_time, current_level_.GetWorld()->GetBodyCount(), current_level_.GetWorld()->GetContactCount());
+            if (fast)
+            {
+                fast_forward_.Record(steps, step_time);
+            }
+            else
+            {
+                fast_forward_.Reset();
+            }
+            rewind_.Record(current_level_, steps);
+            // The world may be drawn at a lower resolution, the HUD below always at full
+            sf::RenderTarget &world = resolution_.Begin(window_, window_.getView());
+            DrawStaticLayer(world);
+            current_level_.Draw(world);
             has_just_settled = settled && !prev_settled;
             // Draw the aiming arrow
-            std::tuple<float, float> tuple = current_level_.DrawArrow(window_);
+            std::tuple<float, float> tuple = current_level_.DrawArrow(window_, world);
+            resolution_.End(window_);
+            drew_world = true;
             // Update arrow direction and power
             direction = std::get<0>(tuple);
             power = std::get<1>(tuple);
@@ -410,7 +681,14 @@ void Game::Start()
             // Reset the bird and view when world settles after a throw
             if (has_just_settled && bird_has_been_thrown && current_level_.GetBird())
             {
+                telemetry_.RecordSettled();
                 current_level_.ResetBird();
+                // Save the attempt with the next bird ready on the slingshot
+                if (!current_level_.IsLevelEnded())
+                {
+                    SaveLevel();
+                    main_menu.ShowContinue(true);
+                }
                 // Update bird_position after reset
                 bird_position = utils::B2ToSfCoords(current_level_.GetBird()->GetBody()->GetPosition());
                 game_view.setCenter(std::max(bird_position.x, window_.getDefaultView().getCenter().x), std::min(bird_position.y, default_center.y));
@@ -442,13 +720,12 @@ void Game::Start()
 
             window_.draw(pause);
 
-            /*
-            if (has_just_settled)
+            if (fast && fast_forward_.GetSpeed() > 1)
             {
-                // Save world to file
-                SaveLevel();
+                speed_text.setPosition(window_.mapPixelToCoords(sf::Vector2i(static_cast<int>(window_.getSize().x * 0.7), 80)));
+                speed_text.setString(">> x" + std::to_string(fast_forward_.GetSpeed()));
+                window_.draw(speed_text);
             }
-            */
 
             if (current_level_.IsLevelEnded() && settled)
             {
@@ -468,11 +745,62 @@ void Game::Start()
                 }
                 end_screen.SelectStars(current_level_.GetStars());
                 end_screen.Open();
+                // A finished attempt is not offered for resuming
+                autosaver_.Discard();
+                main_menu.ShowContinue(false);
+                telemetry_.EndAttempt(current_level_.GetScore(), current_level_.GetStars(), current_level_.CountPigs() == 0, true);
             }
         }
 
+        // Keep drawing every frame while the world moves, the mouse button is held or
+        // a menu has just been opened or closed. Otherwise idle until the next input event.
+        int open_menus = main_menu.IsOpen() | level_selector.IsOpen() << 1 | pause_menu.IsOpen() << 2 | end_screen.IsOpen() << 3 | high_scores.IsOpen() << 4;
+        redraw = (!IsMenuOpen() && (!settled || current_level_.HasParticles())) || sf::Mouse::isButtonPressed(sf::Mouse::Left) || open_menus != prev_open_menus ||
+                 (level_selector.IsOpen() && level_selector.IsLoading());
+        prev_open_menus = open_menus;
+
+        if (show_memory_)
+        {
+            // Drawn over everything in window coordinates
+            sf::View view = window_.getView();
+            window_.setView(window_.getDefaultView());
+            memory_text.setString(memory_stats::Summary() + pacer_.Summary() +
+                                  "Resolution: " + std::to_string(static_cast<int>(resolution_.GetScale() * 100 + 0.5f)) + "%\n");
+            window_.draw(memory_text);
+            window_.setView(view);
+        }
+
+        // Stopped before display, which blocks until the next vertical blank with vsync
+        // and would make every frame look a full refresh period long
+        sf::Time frame_time = frame_clock.getElapsedTime();
         window_.display();
+        if (drew_world)
+        {
+            resolution_.Update(frame_time);
+        }
+        pacer_.FrameDone();
     }
+
+    pacer_.PrintReport(std::cout);
+    telemetry_.EndAttempt(current_level_.GetScore(), current_level_.GetStars(), false, false);
+    utils::MakeDirectory(cache_directory);
+    std::ofstream memory_report(cache_directory + "/memory.json");
+    memory_stats::WriteJson(memory_report);
+}
+
+bool Game::WaitEvent(sf::Event &event, sf::Time timeout)
+{
+    // sf::Window::waitEvent can't time out so poll with short sleeps in between
+    sf::Clock clock;
+    while (clock.getElapsedTime() < timeout)
+    {
+        if (window_.pollEvent(event))
+        {
+            return true;
+        }
+        sf::sleep(idle_poll_interval);
+    }
+    return false;
 }
 
 void Game::UpdateSavedHighScore(std::list<std::tuple<std::string, int>> high_scores)
@@ -508,4 +836,11 @@ void Game::UpdateSavedHighScore(std::list<std::tuple<std::string, int>> high_sco
         output << line << std::endl;
     }
     output.close();
+
+    int best_score = 0;
+    for (const auto &high_score : high_scores)
+    {
+        best_score = std::max(best_score, std::get<1>(high_score));
+    }
+    LevelCatalog::Get().SetBestScore(current_level_file_name_, best_score);
 }
\ No newline at end of file
@@ -10,24 +10,56 @@
 #include <fstream>
 #include <sstream>
 #include "utils.hpp"
+#include "atlas.hpp"
+#include "autosave.hpp"
+#include "static_layer.hpp"
+#include "level_catalog.hpp"
+#include "memory_stats.hpp"
+#include "fast_forward.hpp"
+#include "frame_pacer.hpp"
+#include "dynamic_resolution.hpp"
+#include "rewind.hpp"
+#include "telemetry.hpp"
 
 class Game
 {
 public:
-    Game();
+    explicit Game(PacingMode pacing = PacingMode::Precise, PhysicsBackend physics = PhysicsBackend::Box2D);
     void LoadLevel(std::string filename);
+    // Loads the newest autosave with the score and damage it had, returns false if there is none
+    bool ResumeLevel();
+    // Snapshots the level and writes it to the next autosave slot in the background
     void SaveLevel();
     void UpdateSavedHighScore(std::list<std::tuple<std::string, int>> high_scores);
     void LoadIcon();
     void Start();
 
 private:
+    // Waits for the next event, returns false if none arrived before the timeout
+    bool WaitEvent(sf::Event &event, sf::Time timeout);
+
+    // Loads the startup assets in the background while showing a progress bar
+    void LoadAssets();
+
+    // Draws the background and the level's static bodies, baking the tiles in view first if needed
+    void DrawStaticLayer(sf::RenderTarget &target);
+
     std::string current_level_file_name_;
     Level current_level_;
     sf::RenderWindow window_;
-    sf::Texture background_texture_;
+    FramePacer pacer_;
+    DynamicResolution resolution_; // The world is drawn through this while playing, HUD and menus aren't
     sf::Sprite bg_sprite_;
+    StaticLayer static_layer_;
+    unsigned static_layer_changes_ = 0; // Level::GetStaticChanges() when the layer was baked
     int victory_achieved_; // Variable for keeping track if the victory sound has already played
+    Autosaver autosaver_;
+    bool show_memory_ = false; // F3 toggles the memory and frame time report
+    FastForward fast_forward_;
+    bool turbo_ = false; // F fast-forwards every throw, otherwise only once the bird has stopped
+    RewindBuffer rewind_; // Backspace rewinds the level
+    PhysicsBackend physics_; // Backend of every level loaded
+    Telemetry telemetry_;    // One record per attempt at a level
 };
 
 #endif // ANGRY_BIRDS_GAME
\ No newline at end of file
@@ -6,18 +6,22 @@
 class Ground : public Object
 {
 public:
-    Ground(b2Body *body) : Object("resources/images/ground.png", body)
+    Ground(b2Body *body) : Object(body, TextureId::Ground, SoundId::Punch, MaterialId::Ground, 50.0f, 1.0f){};
+
+    // The ground texture is tiled along the whole body instead of being stretched
+    sf::Sprite GetSprite() const
     {
-        float w = static_cast<float>(sprite_.getTextureRect().width);
-        float h = static_cast<float>(sprite_.getTextureRect().height);
+        sf::Sprite sprite = Resources::Get().GetSprite(texture_);
+        float w = static_cast<float>(sprite.getTextureRect().width);
+        float h = static_cast<float>(sprite.getTextureRect().height);
         float TEXTURE_SCALE = 64.0f;
 
-        sprite_.setScale(50.0f * TEXTURE_SCALE / w, 10.0f * TEXTURE_SCALE / h);
-        texture_.setRepeated(true);
-        sprite_.setTextureRect({0, 0, static_cast<int>(100 * scale), static_cast<int>(6 * scale)}); // just hard coded based on Level Constructor
+        sprite.setScale(50.0f * TEXTURE_SCALE / w, 10.0f * TEXTURE_SCALE / h);
+        sprite.setTextureRect({0, 0, static_cast<int>(100 * scale), static_cast<int>(6 * scale)}); // just hard coded based on Level Constructor
 
-        sprite_.setOrigin(0, 150);
-    };
+        sprite.setOrigin(0, 150);
+        return sprite;
+    }
 
     virtual char GetType() { return 'G'; };
     int TryToDestroy(float power)
@@ -1,47 +1,13 @@
 #include "high_scores.hpp"
+#include "level_catalog.hpp"
 
-HighScores::HighScores(Level level) : Menu()
+HighScores::HighScores() : Menu()
 {
-    SetLevel(level);
-}
-
-void HighScores::SetLevel(Level level)
-{
-    std::list<std::tuple<std::string, int>> high_scores = level.GetHighScores();
-    high_scores.sort(utils::CmpHighScore);
-    high_scores.reverse();
-    std::vector<std::tuple<std::string, int>> hs_vector{std::begin(high_scores), std::end(high_scores)};
-
     for (int i = 0; i < list_length_; i++)
     {
-        std::stringstream text;
-        std::tuple<std::string, int> tuple = hs_vector[i];
-        text << std::get<0>(tuple) << ": " << std::get<1>(tuple);
         high_scores_[i].setFont(font_);
         high_scores_[i].setFillColor(sf::Color::White);
-        high_scores_[i].setString(text.str());
         high_scores_[i].setCharacterSize(40);
-        sf::FloatRect rc = high_scores_[i].getLocalBounds();
-        high_scores_[i].setOrigin(rc.width / 2, rc.height / 2);
-        high_scores_[i].setPosition(800, 200 + i * 60);
-    }
-
-    for (int i = 0; i < 3; i++)
-    {
-        level_buttons_[i].setFont(font_);
-        level_buttons_[i].setFillColor(sf::Color::White);
-        level_buttons_[i].setString("Level " + std::to_string(i + 1));
-        level_buttons_[i].setCharacterSize(60);
-        level_buttons_[i].setPosition(1200, 300 + i * 100);
-        level_buttons_[i].setOutlineColor(sf::Color::Black);
-        if (level.GetName() == "Level " + std::to_string(i + 1))
-        {
-            level_buttons_[i].setOutlineThickness(3);
-        }
-        else
-        {
-            level_buttons_[i].setOutlineThickness(0);
-        }
     }
 
     rect_.setFillColor(sf::Color(0, 0, 0, 170));
@@ -65,17 +31,77 @@ void HighScores::SetLevel(Level level)
     header_.setPosition(800, 50);
 }
 
+void HighScores::SetScores(const LevelScores &scores)
+{
+    if (scores.level_number == shown_level_ && scores.revision == shown_revision_)
+    {
+        return;
+    }
+    shown_level_ = scores.level_number;
+    shown_revision_ = scores.revision;
+
+    for (int i = 0; i < list_length_; i++)
+    {
+        std::stringstream text;
+        if (i < static_cast<int>(scores.entries.size()))
+        {
+            const std::tuple<std::string, int> &tuple = scores.entries[i];
+            text << std::get<0>(tuple) << ": " << std::get<1>(tuple);
+        }
+        high_scores_[i].setString(text.str());
+        sf::FloatRect rc = high_scores_[i].getLocalBounds();
+        high_scores_[i].setOrigin(rc.width / 2, rc.height / 2);
+        high_scores_[i].setPosition(800, 200 + i * 60);
+    }
+
+    // Buttons for the levels around the current one, the current one outlined
+    const std::vector<LevelInfo> &levels = LevelCatalog::Get().GetLevels();
+    int current = 0;
+    while (current < static_cast<int>(levels.size()) && levels[current].number != scores.level_number)
+    {
+        current++;
+    }
+    int first = std::max(0, std::min(current - button_count_ / 2, static_cast<int>(levels.size()) - button_count_));
+    level_buttons_.clear();
+    level_paths_.clear();
+    for (int i = first; i < static_cast<int>(levels.size()) && i < first + button_count_; i++)
+    {
+        sf::Text button;
+        button.setFont(font_);
+        button.setFillColor(sf::Color::White);
+        button.setString(levels[i].name);
+        button.setCharacterSize(60);
+        button.setPosition(1200, 300 + (i - first) * 100.0f);
+        button.setOutlineColor(sf::Color::Black);
+        button.setOutlineThickness(i == current ? 3 : 0);
+        level_buttons_.push_back(button);
+        level_paths_.push_back(levels[i].path);
+    }
+}
+
+std::string HighScores::LevelAt(sf::Vector2f position) const
+{
+    for (size_t i = 0; i < level_buttons_.size(); i++)
+    {
+        if (level_buttons_[i].getGlobalBounds().contains(position))
+        {
+            return level_paths_[i];
+        }
+    }
+    return "";
+}
+
 void HighScores::Draw(sf::RenderWindow &window)
 {
     window.draw(background_);
     window.draw(back_button_);
     window.draw(header_);
     window.draw(rect_);
-    for (auto high_score : high_scores_)
+    for (const auto &high_score : high_scores_)
     {
         window.draw(high_score);
     }
-    for (auto level_button : level_buttons_)
+    for (const auto &level_button : level_buttons_)
     {
         window.draw(level_button);
     }
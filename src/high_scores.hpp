@@ -5,21 +5,30 @@
 #include "menu.hpp"
 #include "utils.hpp"
 #include <string>
+#include <vector>
 
 class HighScores : public Menu
 {
 public:
-    HighScores(Level level);
+    HighScores();
     void Draw(sf::RenderWindow &window);
-    void SetLevel(Level level);
+    // Rebuilds the score list only when the level or its scores have changed
+    void SetScores(const LevelScores &scores);
+
+    // Level file of the level button under the position or an empty string
+    std::string LevelAt(sf::Vector2f position) const;
 
 private:
     const static int list_length_ = 10;
     sf::Text high_scores_[list_length_];
     sf::Text header_;
     sf::Text back_button_;
-    sf::Text level_buttons_[3];
+    const static int button_count_ = 5; // Level buttons shown around the current level
+    std::vector<sf::Text> level_buttons_;
+    std::vector<std::string> level_paths_;
     sf::RectangleShape rect_;
+    int shown_level_ = -1;
+    unsigned shown_revision_ = 0;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,402 @@
+#include "island_world.hpp"
+#include "task_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <set>
+
+namespace
+{
+    const int rebalance_interval = 60;  // Steps between spreading the islands out again
+    const int min_parallel_bodies = 48; // Smaller worlds aren't worth splitting up
+    const float imbalance = 1.25f;      // Islands are spread out when a shard has this many times its share
+    const float contact_margin = 0.2f;  // Meters on top of how far a body moves in a step
+
+    struct Island
+    {
+        int shard;
+        std::vector<b2Body *> bodies;
+    };
+
+    // Bounding box of the body's fixtures grown by how far it can get during the step
+    b2AABB Reach(b2Body *body, float time_step)
+    {
+        b2AABB box;
+        box.lowerBound = box.upperBound = body->GetPosition();
+        for (b2Fixture *fixture = body->GetFixtureList(); fixture; fixture = fixture->GetNext())
+        {
+            for (int32 child = 0; child < fixture->GetShape()->GetChildCount(); child++)
+            {
+                box.Combine(fixture->GetAABB(child));
+            }
+        }
+        b2Vec2 velocity = body->GetLinearVelocity();
+        b2Vec2 margin(std::abs(velocity.x) * time_step + contact_margin, std::abs(velocity.y) * time_step + contact_margin);
+        box.lowerBound -= margin;
+        box.upperBound += margin;
+        return box;
+    }
+}
+
+IslandWorld::IslandWorld(const b2Vec2 &gravity, int shard_count)
+    : steps_since_rebalance_(rebalance_interval - 1) // The first step finds the contacts, the islands are spread out right after
+{
+    if (shard_count <= 0)
+    {
+        shard_count = TaskPool::Get().GetThreadCount();
+    }
+    for (int i = 0; i < shard_count; i++)
+    {
+        shards_.emplace_back(new Box2DWorld(gravity));
+    }
+}
+
+int IslandWorld::ShardOf(b2Body *body)
+{
+    for (size_t i = 0; i < shards_.size(); i++)
+    {
+        if (&shards_[i]->GetB2World() == body->GetWorld())
+        {
+            return static_cast<int>(i);
+        }
+    }
+    return 0;
+}
+
+b2Body *IslandWorld::CreateBody(const b2BodyDef &def)
+{
+    // Everything starts out in the first shard, Rebalance spreads the bodies out once it knows the islands
+    b2Body *body = shards_[0]->CreateBody(def);
+    if (def.type == b2_staticBody && shards_.size() > 1)
+    {
+        uncopied_.push_back(body);
+    }
+    return body;
+}
+
+void IslandWorld::DestroyBody(b2Body *body)
+{
+    if (body->GetType() == b2_staticBody)
+    {
+        uncopied_.erase(std::remove(uncopied_.begin(), uncopied_.end(), body), uncopied_.end());
+        auto copies = copies_.find(body);
+        if (copies != copies_.end())
+        {
+            for (size_t i = 0; i < copies->second.size(); i++)
+            {
+                shards_[i + 1]->DestroyBody(copies->second[i]);
+            }
+            copies_.erase(copies);
+        }
+    }
+    shards_[ShardOf(body)]->DestroyBody(body);
+}
+
+b2Body *IslandWorld::CopyBody(b2Body *body, int shard)
+{
+    b2BodyDef def;
+    def.type = body->GetType();
+    def.position = body->GetPosition();
+    def.angle = body->GetAngle();
+    def.linearVelocity = body->GetLinearVelocity();
+    def.angularVelocity = body->GetAngularVelocity();
+    def.linearDamping = body->GetLinearDamping();
+    def.angularDamping = body->GetAngularDamping();
+    def.allowSleep = body->IsSleepingAllowed();
+    def.awake = body->IsAwake();
+    def.fixedRotation = body->IsFixedRotation();
+    def.bullet = body->IsBullet();
+    def.enabled = body->IsEnabled();
+    def.userData = body->GetUserData();
+    def.gravityScale = body->GetGravityScale();
+    b2Body *copy = shards_[shard]->CreateBody(def);
+
+    for (b2Fixture *fixture = body->GetFixtureList(); fixture; fixture = fixture->GetNext())
+    {
+        b2FixtureDef fixture_def;
+        fixture_def.shape = fixture->GetShape();
+        fixture_def.userData = fixture->GetUserData();
+        fixture_def.friction = fixture->GetFriction();
+        fixture_def.restitution = fixture->GetRestitution();
+        fixture_def.density = fixture->GetDensity();
+        fixture_def.isSensor = fixture->IsSensor();
+        fixture_def.filter = fixture->GetFilterData();
+        copy->CreateFixture(&fixture_def);
+    }
+    return copy;
+}
+
+void IslandWorld::MoveBody(b2Body *body, int shard)
+{
+    b2Body *copy = CopyBody(body, shard);
+    // A body merged and then rebalanced in the same step is moved twice. It is reported once,
+    // from the body the caller knows to the newest one, since the one in between is gone.
+    auto earlier = std::find_if(moved_.begin(), moved_.end(), [body](const BodyMove &move)
+                                { return move.to == body; });
+    if (earlier != moved_.end())
+    {
+        earlier->to = copy;
+    }
+    else
+    {
+        moved_.push_back({body, copy});
+    }
+    shards_[ShardOf(body)]->DestroyBody(body);
+}
+
+void IslandWorld::MoveAll(int from, int to)
+{
+    std::vector<b2Body *> bodies;
+    shards_[from]->ForEachBody([&bodies](b2Body *body)
+                               {
+                                   if (body->GetType() != b2_staticBody)
+                                   {
+                                       bodies.push_back(body);
+                                   } });
+    for (b2Body *body : bodies)
+    {
+        MoveBody(body, to);
+    }
+}
+
+void IslandWorld::CopyNewStaticBodies()
+{
+    for (b2Body *body : uncopied_)
+    {
+        std::vector<b2Body *> &copies = copies_[body];
+        for (size_t i = 1; i < shards_.size(); i++)
+        {
+            copies.push_back(CopyBody(body, static_cast<int>(i)));
+        }
+    }
+    uncopied_.clear();
+}
+
+int IslandWorld::CountShardBodies(int shard)
+{
+    int count = 0;
+    shards_[shard]->ForEachBody([&count](b2Body *body)
+                                { count += body->GetType() != b2_staticBody; });
+    return count;
+}
+
+void IslandWorld::MergeNearbyShards(float time_step)
+{
+    int n = GetShardCount();
+    std::vector<int> group(n);
+    std::iota(group.begin(), group.end(), 0);
+    auto find = [&group](int shard)
+    {
+        while (group[shard] != shard)
+        {
+            shard = group[shard] = group[group[shard]];
+        }
+        return shard;
+    };
+
+    // Sleeping bodies don't move, the awake ones coming their way find them
+    for (int s = 0; s < n; s++)
+    {
+        shards_[s]->ForEachBody([&](b2Body *body)
+                                {
+                                    if (body->GetType() == b2_staticBody || !body->IsAwake() || !body->IsEnabled())
+                                    {
+                                        return;
+                                    }
+                                    b2AABB reach = Reach(body, time_step);
+                                    for (int t = 0; t < n; t++)
+                                    {
+                                        if (find(t) == find(s))
+                                        {
+                                            continue;
+                                        }
+                                        bool near = false;
+                                        shards_[t]->QueryAABB(reach, [&near](b2Fixture *fixture)
+                                                              {
+                                                                  near = fixture->GetBody()->GetType() != b2_staticBody;
+                                                                  return !near; });
+                                        if (near)
+                                        {
+                                            group[find(t)] = find(s);
+                                        }
+                                    } });
+    }
+
+    // Every group ends up in the shard of it that has the most bodies, so the fewest have to move
+    std::vector<int> counts(n), target(n, -1);
+    for (int s = 0; s < n; s++)
+    {
+        counts[s] = CountShardBodies(s);
+    }
+    for (int s = 0; s < n; s++)
+    {
+        int &best = target[find(s)];
+        if (best < 0 || counts[s] > counts[best])
+        {
+            best = s;
+        }
+    }
+    for (int s = 0; s < n; s++)
+    {
+        int to = target[find(s)];
+        if (to != s && counts[s] > 0)
+        {
+            MoveAll(s, to);
+        }
+    }
+}
+
+void IslandWorld::Rebalance()
+{
+    // Islands are found through the contacts, static bodies don't join them
+    std::vector<Island> islands;
+    std::set<b2Body *> visited;
+    int total = 0;
+    for (int s = 0; s < GetShardCount(); s++)
+    {
+        shards_[s]->ForEachBody([&](b2Body *body)
+                                {
+                                    if (body->GetType() == b2_staticBody || !visited.insert(body).second)
+                                    {
+                                        return;
+                                    }
+                                    islands.push_back({s, {body}});
+                                    std::vector<b2Body *> &members = islands.back().bodies;
+                                    for (size_t i = 0; i < members.size(); i++)
+                                    {
+                                        for (b2ContactEdge *edge = members[i]->GetContactList(); edge; edge = edge->next)
+                                        {
+                                            if (edge->other->GetType() != b2_staticBody && visited.insert(edge->other).second)
+                                            {
+                                                members.push_back(edge->other);
+                                            }
+                                        }
+                                    }
+                                    total += static_cast<int>(members.size()); });
+    }
+    if (total < min_parallel_bodies || islands.size() < 2)
+    {
+        return;
+    }
+
+    int n = GetShardCount();
+    int share = (total + n - 1) / n;
+    std::vector<int> loads(n, 0);
+    for (const auto &island : islands)
+    {
+        loads[island.shard] += static_cast<int>(island.bodies.size());
+    }
+    if (*std::max_element(loads.begin(), loads.end()) <= share * imbalance)
+    {
+        return;
+    }
+
+    // Biggest islands first, each stays where it is if there's room and otherwise goes to the emptiest shard
+    std::stable_sort(islands.begin(), islands.end(), [](const Island &a, const Island &b)
+                     { return a.bodies.size() > b.bodies.size(); });
+    std::fill(loads.begin(), loads.end(), 0);
+    for (const auto &island : islands)
+    {
+        int size = static_cast<int>(island.bodies.size());
+        int to = island.shard;
+        if (loads[to] + size > share)
+        {
+            to = static_cast<int>(std::min_element(loads.begin(), loads.end()) - loads.begin());
+        }
+        loads[to] += size;
+        if (to != island.shard)
+        {
+            for (b2Body *body : island.bodies)
+            {
+                MoveBody(body, to);
+            }
+        }
+    }
+}
+
+void IslandWorld::Step(float time_step, int velocity_iterations, int position_iterations)
+{
+    moved_.clear();
+    if (shards_.size() > 1)
+    {
+        CopyNewStaticBodies();
+        MergeNearbyShards(time_step);
+    }
+
+    // Shards with nothing but static bodies have nothing to simulate
+    std::vector<int> active;
+    for (int s = 0; s < GetShardCount(); s++)
+    {
+        if (CountShardBodies(s) > 0)
+        {
+            active.push_back(s);
+        }
+    }
+    TaskPool::Get().Run(static_cast<int>(active.size()), [&](int i)
+                        { shards_[active[i]]->Step(time_step, velocity_iterations, position_iterations); });
+
+    if (shards_.size() > 1 && ++steps_since_rebalance_ >= rebalance_interval)
+    {
+        steps_since_rebalance_ = 0;
+        Rebalance();
+    }
+}
+
+int IslandWorld::GetBodyCount() const
+{
+    int count = 0;
+    for (const auto &shard : shards_)
+    {
+        count += shard->GetBodyCount();
+    }
+    return count - static_cast<int>(copies_.size() * (shards_.size() - 1));
+}
+
+int IslandWorld::GetContactCount() const
+{
+    int count = 0;
+    for (const auto &shard : shards_)
+    {
+        count += shard->GetContactCount();
+    }
+    return count;
+}
+
+void IslandWorld::ForEachBody(const std::function<void(b2Body *)> &callback)
+{
+    shards_[0]->ForEachBody(callback);
+    for (size_t i = 1; i < shards_.size(); i++)
+    {
+        shards_[i]->ForEachBody([&callback](b2Body *body)
+                                {
+                                    if (body->GetType() != b2_staticBody)
+                                    {
+                                        callback(body);
+                                    } });
+    }
+}
+
+void IslandWorld::ForEachContact(const std::function<void(b2Contact *)> &callback)
+{
+    for (const auto &shard : shards_)
+    {
+        shard->ForEachContact(callback);
+    }
+}
+
+void IslandWorld::QueryAABB(const b2AABB &aabb, const std::function<bool(b2Fixture *)> &callback)
+{
+    // Static copies are left out so every fixture is reported once
+    bool go_on = true;
+    for (size_t i = 0; i < shards_.size() && go_on; i++)
+    {
+        shards_[i]->QueryAABB(aabb, [&](b2Fixture *fixture)
+                              {
+                                  if (i > 0 && fixture->GetBody()->GetType() == b2_staticBody)
+                                  {
+                                      return true;
+                                  }
+                                  go_on = callback(fixture);
+                                  return go_on; });
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef ANGRY_BIRDS_ISLAND_WORLD
+#define ANGRY_BIRDS_ISLAND_WORLD
+
+#include "physics_world.hpp"
+#include <map>
+
+// Splits the bodies into shards, each its own b2World, and steps the shards in
+// parallel on the TaskPool. Bodies that touch, or are about to, are always in the
+// same shard: before every step the shards whose moving bodies come close to each
+// other are merged, and every now and then the islands (bodies connected through
+// contacts) are spread out over the shards again. Moving a body between shards
+// recreates it, see GetMovedBodies.
+//
+// Static bodies live in the first shard and are copied into the others on the next
+// step. The copies aren't updated afterwards, so static bodies shouldn't be moved.
+// Joints aren't supported.
+class IslandWorld : public PhysicsWorld
+{
+public:
+    // With shard_count 0 there is a shard for every thread of the task pool
+    explicit IslandWorld(const b2Vec2 &gravity, int shard_count = 0);
+
+    b2Body *CreateBody(const b2BodyDef &def) override;
+    void DestroyBody(b2Body *body) override;
+    void Step(float time_step, int velocity_iterations, int position_iterations) override;
+    const std::vector<BodyMove> &GetMovedBodies() const override { return moved_; }
+    int GetBodyCount() const override;
+    int GetContactCount() const override;
+    void ForEachBody(const std::function<void(b2Body *)> &callback) override;
+    void ForEachContact(const std::function<void(b2Contact *)> &callback) override;
+    void QueryAABB(const b2AABB &aabb, const std::function<bool(b2Fixture *)> &callback) override;
+    PhysicsBackend GetBackend() const override { return PhysicsBackend::Islands; }
+
+    int GetShardCount() const { return static_cast<int>(shards_.size()); }
+
+    // Bodies in the shard that aren't static
+    int CountShardBodies(int shard);
+
+private:
+    int ShardOf(b2Body *body);
+
+    // Creates a body like body in the shard, fixtures included
+    b2Body *CopyBody(b2Body *body, int shard);
+
+    void MoveBody(b2Body *body, int shard);
+
+    // Moves everything that isn't static out of the shard
+    void MoveAll(int from, int to);
+
+    void CopyNewStaticBodies();
+
+    // Merges shards whose awake bodies could touch during the next step
+    void MergeNearbyShards(float time_step);
+
+    // Spreads the islands evenly over the shards
+    void Rebalance();
+
+    std::vector<std::unique_ptr<Box2DWorld>> shards_;
+    std::map<b2Body *, std::vector<b2Body *>> copies_; // Static bodies of the first shard and their copies in the others
+    std::vector<b2Body *> uncopied_;                   // Static bodies created since the last step
+    std::vector<BodyMove> moved_;
+    int steps_since_rebalance_;
+};
+
+#endif // ANGRY_BIRDS_ISLAND_WORLD
@@ -3,9 +3,13 @@
 #include "ground.hpp"
 #include "utils.hpp"
 #include "wall.hpp"
+#include "atlas.hpp"
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <iostream>
 #include <SFML/Audio.hpp>
+#include <atomic>
 
 Level::Level() : name_("") {}
 
@@ -16,15 +20,15 @@ std::vector<int> Level::CountBirdTypes()
     int speed_count = 0;
     for (const auto &bird : birds_)
     {
-        if (BoomerangBird *v = dynamic_cast<BoomerangBird *>(bird))
+        if (BoomerangBird *v = dynamic_cast<BoomerangBird *>(bird.get()))
         {
             boomerang_count++;
         }
-        if (DroppingBird *v = dynamic_cast<DroppingBird *>(bird))
+        if (DroppingBird *v = dynamic_cast<DroppingBird *>(bird.get()))
         {
             dropping_count++;
         }
-        if (SpeedBird *v = dynamic_cast<SpeedBird *>(bird))
+        if (SpeedBird *v = dynamic_cast<SpeedBird *>(bird.get()))
         {
             speed_count++;
         }
@@ -35,187 +39,256 @@ std::vector<int> Level::CountBirdTypes()
 
 int Level::CountPigs()
 {
-    int pig_count = 0;
+    int pig_count = dormant_pigs_;
     for (const auto &obj : objects_)
     {
-        if (Pig *v = dynamic_cast<Pig *>(obj))
+        if (Pig *v = dynamic_cast<Pig *>(obj.get()))
         {
             pig_count++;
         }
     }
     return pig_count;
 }
-Level::Level(std::ifstream &file)
+
+std::list<Object *> Level::objects()
 {
-    if (file.rdstate() & (file.failbit | file.badbit))
+    std::list<Object *> objects;
+    for (const auto &obj : objects_)
     {
-        std::cerr << "Failed" << std::endl; // output error to stderr stream
+        objects.push_back(obj.get());
     }
-    else
+    return objects;
+}
+
+namespace
+{
+    const int streaming_interval = 10; // Steps between checks of which chunks should be loaded
+    const float chunk_margin = 8.0f;   // Meters around the view and the bird that are kept loaded
+    const float path_lookahead = 1.0f; // Seconds of the bird's flight that are loaded ahead of it
+    const float bounds_left = -2.0f;    // Play area in meters, the right edge follows the level's width
+    const float bounds_bottom = -10.0f; // Well below the ground, only reached by falling off its ends
+    const float bounds_top = 100.0f;
+
+    bool IsBirdType(char type)
     {
-        // Read level name from the first line
-        if (!file.eof())
-        {
-            std::string name;
-            std::getline(file, name);
-            name_ = name;
-        }
-        level_number_ = std::stoi(name_.substr(5, name_.size() - 3));
-        char _; // character dump
-        // Read highscores from second line
-        std::string high_scores_string;
-        std::getline(file, high_scores_string);
-        std::stringstream hs_ss(high_scores_string);
+        return type == 'B' || type == 'D' || type == 'S';
+    }
 
-        std::list<std::tuple<std::string, int>> high_scores;
-        std::string high_score;
-        std::getline(hs_ss, high_score, ';');
-        while (hs_ss.good())
-        {
-            int score;
-            std::string name, score_str;
-            std::stringstream tmp(high_score);
-            std::getline(tmp, name, ':');
-            std::getline(tmp, score_str);
-            score = std::stoi(score_str);
+    // Destruction threshold of an undamaged object of the type
+    float FullHealth(char type)
+    {
+        MaterialId material = type == 'P' ? MaterialId::Pig : type == 'G' ? MaterialId::Ground : MaterialId::Wall;
+        return Resources::Get().GetMaterial(material).destruction_threshold;
+    }
 
-            high_scores.push_back({name, score});
-            std::getline(hs_ss, high_score, ';');
-        }
+    sf::Sprite SlingshotSprite()
+    {
+        sf::Sprite slingshot;
+        TextureAtlas::Get().Apply(slingshot, "slingshot");
+        sf::Vector2f slingshot_size(100.0f, 150.0f);
+        float slingshot_w = static_cast<float>(slingshot.getTextureRect().width);
+        float slingshot_h = static_cast<float>(slingshot.getTextureRect().height);
+        slingshot.setScale(slingshot_size.x / slingshot_w, slingshot_size.y / slingshot_h);
+        slingshot.setOrigin(slingshot_w / 2, slingshot_h * 0.3f);
+        slingshot.setPosition(utils::B2ToSfCoords(bird_starting_position));
+        return slingshot;
+    }
 
-        high_scores_ = high_scores;
+    sf::FloatRect Union(const sf::FloatRect &a, const sf::FloatRect &b)
+    {
+        float left = std::min(a.left, b.left);
+        float top = std::min(a.top, b.top);
+        float right = std::max(a.left + a.width, b.left + b.width);
+        float bottom = std::max(a.top + a.height, b.top + b.height);
+        return sf::FloatRect(left, top, right - left, bottom - top);
+    }
 
-        // Read bird list from third line
-        std::string bird_list;
-        std::getline(file, bird_list);
+    // Pixels the object covers, worked out from its body alone so no texture is needed
+    sf::FloatRect Footprint(Object &object)
+    {
+        b2Body *body = object.GetBody();
+        b2Vec2 half_size = object.GetHalfSize();
+        float cos_angle = std::abs(std::cos(body->GetAngle()));
+        float sin_angle = std::abs(std::sin(body->GetAngle()));
+        sf::Vector2f extent((cos_angle * half_size.x + sin_angle * half_size.y) * scale,
+                            (sin_angle * half_size.x + cos_angle * half_size.y) * scale);
+        sf::Vector2f center = utils::B2ToSfCoords(body->GetPosition());
+        return sf::FloatRect(center - extent, extent * 2.0f);
+    }
 
-        world_ = new b2World(gravity);
+    sf::Sprite StaticSprite(Object &object)
+    {
+        b2Body *body = object.GetBody();
+        sf::Sprite sprite = object.GetSprite();
+        sprite.setPosition(utils::B2ToSfCoords(body->GetPosition()));
+        sprite.setRotation(utils::RadiansToDegrees(body->GetAngle()) * -1.0f);
+        return sprite;
+    }
 
-        while (!file.eof())
+    LevelAsset ParseLevel(std::istream &file)
+    {
+        std::vector<std::string> errors;
+        LevelAsset asset = level_asset::Parse(file, errors);
+        for (const auto &error : errors)
         {
-            char obj_type;
-            file.get(obj_type);
-            file.ignore(); // Ignore the following separator
-
-            // Read the body definition
-            b2BodyDef body_def;
+            std::cerr << "Reading Level file: " << error << std::endl; // output error to stderr stream
+        }
+        return asset;
+    }
+}
 
-            file >> body_def.position >> _ >> body_def.angle >> _ >> body_def.angularVelocity >> _ >> body_def.linearVelocity >> _ >> body_def.angularDamping >> _ >> body_def.linearDamping >> _ >> body_def.gravityScale >> _ >> body_def.type >> _ >> body_def.awake >> _;
+Level::Level(std::istream &file, PhysicsBackend backend) : Level(ParseLevel(file), backend) {}
 
-            b2Body *body = world_->CreateBody(&body_def);
+Level::Level(const LevelAsset &asset, PhysicsBackend backend)
+    : name_(asset.name), backend_(backend), score_(asset.score), high_scores_(asset.high_scores), level_number_(asset.number)
+{
+    UpdateScores();
+    world_ = PhysicsWorld::Create(backend_, gravity);
 
-            std::string fixture_str;
-            // Read fixtures
-            std::getline(file, fixture_str, '\n');
-            std::stringstream fixture(fixture_str);
-            b2FixtureDef fixture_def;
+    // Assets put together in code may not be sorted into chunks yet
+    LevelAsset sorted;
+    const LevelAsset *source = &asset;
+    if (asset.chunks.empty() && !asset.bodies.empty())
+    {
+        sorted = asset;
+        level_asset::SortIntoChunks(sorted);
+        source = &sorted;
+    }
 
-            int shape_type;
-            fixture >> shape_type >> _;
+    // Bodies are identified by their index in the asset from now on
+    originals_ = source->bodies;
 
-            // The shapes need to live in the outer scope here so the fixture can see them
-            b2CircleShape circle;
-            b2PolygonShape polygon;
-            switch (shape_type)
-            {
-            case b2Shape::Type::e_circle:
-            {
-                fixture >> circle.m_p >> _ >> circle.m_radius >> _;
-                fixture_def.shape = &circle;
-                break;
-            }
-            case b2Shape::Type::e_polygon:
+    // Chunks away from the slingshot start out unloaded
+    for (const auto &range : source->chunks)
+    {
+        for (uint32_t id = range.first; id < range.first + range.count; id++)
+        {
+            const BodyRecord &record = originals_[id];
+            world_right_ = std::max(world_right_, record.position.x);
+            // Saves carry the damage taken before saving
+            float health = FullHealth(record.type) - record.damage;
+            if (range.chunk == resident_chunk || IsChunkActive(range.chunk))
             {
-                fixture >> polygon.m_centroid >> _;
-
-                for (int i = 0; i < 8; i++)
+                Object *object = AddBody(id, record, asset.birds);
+                if (object != nullptr && record.damage > 0)
                 {
-                    b2Vec2 vertex;
-                    fixture >> vertex >> _;
-                    polygon.m_vertices[i] = vertex; // Update array in place since c++ only supports array copying with memcpy
+                    object->SetDThreshold(health);
                 }
-                for (int i = 0; i < 8; i++)
-                {
-                    b2Vec2 normal;
-                    fixture >> normal >> _;
-                    polygon.m_normals[i] = normal;
-                }
-
-                fixture >> polygon.m_count >> _ >> polygon.m_radius >> _;
-
-                fixture_def.shape = &polygon;
-                break;
             }
-            default:
-                std::cerr << "Reading Level file failed, unknown shape on a fixture" << std::endl;
-                break;
+            else
+            {
+                dormant_chunks_[range.chunk].push_back({id, health, record});
+                dormant_pigs_ += record.type == 'P';
             }
+        }
+    }
+    bounds_.lowerBound.Set(bounds_left, bounds_bottom);
+    bounds_.upperBound.Set(std::max((viewwidth * 1.5f) / scale, world_right_ + chunk_margin), bounds_top);
+    for (int i = 0; i < 3; i++)
+    {
+        star_tresholds_.push_back(asset.star_thresholds[i]);
+    }
+}
 
-            fixture >> fixture_def.density >> _ >> fixture_def.friction >> _ >> fixture_def.restitution >> _;
+Object *Level::AddBody(uint32_t id, const BodyRecord &record, const std::string &birds)
+{
+    b2BodyDef body_def;
+    body_def.position = record.position;
+    body_def.angle = record.angle;
+    body_def.angularVelocity = record.angular_velocity;
+    body_def.linearVelocity = record.linear_velocity;
+    body_def.angularDamping = record.angular_damping;
+    body_def.linearDamping = record.linear_damping;
+    body_def.gravityScale = record.gravity_scale;
+    body_def.type = static_cast<b2BodyType>(record.body_type);
+    body_def.awake = record.awake != 0;
+
+    b2Body *body = world_->CreateBody(body_def);
+
+    b2FixtureDef fixture_def;
+    // The shapes need to live in the outer scope here so the fixture can see them
+    b2CircleShape circle;
+    b2PolygonShape polygon;
+    if (record.shape_type == b2Shape::Type::e_circle)
+    {
+        circle.m_p = record.center;
+        circle.m_radius = record.radius;
+        fixture_def.shape = &circle;
+    }
+    else
+    {
+        polygon.m_centroid = record.center;
+        for (int i = 0; i < record.vertex_count; i++)
+        {
+            polygon.m_vertices[i] = record.vertices[i];
+            polygon.m_normals[i] = record.normals[i];
+        }
+        polygon.m_count = record.vertex_count;
+        polygon.m_radius = record.radius;
+        fixture_def.shape = &polygon;
+    }
+    fixture_def.density = record.density;
+    fixture_def.friction = record.friction;
+    fixture_def.restitution = record.restitution;
 
-            switch (obj_type)
+    switch (record.type)
+    {
+    case 'B':
+    case 'D':
+    case 'S':
+    {
+        for (auto type : birds)
+        {
+            Bird *bird;
+            switch (type)
             {
             case 'B':
-            case 'D':
-            case 'S':
-            {
-                for (auto type : bird_list)
-                {
-                    Bird *bird;
-                    switch (type)
-                    {
-                    case 'B':
-                        bird = new BoomerangBird(body, fixture_def.shape->m_radius);
-                        break;
-                    case 'D':
-                        bird = new DroppingBird(body, fixture_def.shape->m_radius);
-                        break;
-                    case 'S':
-                        bird = new SpeedBird(body, fixture_def.shape->m_radius);
-                        break;
-                    default:
-                        // Unknown bird
-                        continue;
-                    }
-                    birds_.push_back(bird);
-                    fixture_def.userData.pointer = reinterpret_cast<uintptr_t>(bird);
-                }
-                break;
-            }
-            case 'G':
-            {
-                Ground *g = new Ground(body);
-                fixture_def.userData.pointer = reinterpret_cast<uintptr_t>(g);
-                objects_.push_back(g);
+                bird = new BoomerangBird(body, record.radius);
                 break;
-            }
-            case 'P':
-            {
-                Pig *p = new Pig(body, fixture_def.shape->m_radius);
-                fixture_def.userData.pointer = reinterpret_cast<uintptr_t>(p);
-                objects_.push_back(p);
-                break;
-            }
-            case 'W':
-            {
-                b2Vec2 dimensions = utils::DimensionsFromPolygon(static_cast<const b2PolygonShape *>(fixture_def.shape));
-                Wall *w = new Wall(body, dimensions.x, dimensions.y);
-                fixture_def.userData.pointer = reinterpret_cast<uintptr_t>(w);
-                objects_.push_back(w);
+            case 'D':
+                bird = new DroppingBird(body, record.radius);
                 break;
-            }
             default:
-                // Unknown type skip row
-                continue;
+                bird = new SpeedBird(body, record.radius);
+                break;
             }
-
-            body->CreateFixture(&fixture_def);
-        }
-        for (int i = 1; i < 4; i++)
-        {
-            star_tresholds_.push_back(((birds_.size() - CountPigs()) * 1000 + CountPigs() * 500) / i);
+            birds_.push_back(std::unique_ptr<Bird>(bird));
+            fixture_def.userData.pointer = reinterpret_cast<uintptr_t>(bird);
         }
+        break;
+    }
+    case 'G':
+    {
+        Ground *g = new Ground(body);
+        fixture_def.userData.pointer = reinterpret_cast<uintptr_t>(g);
+        objects_.push_back(std::unique_ptr<Object>(g));
+        break;
     }
+    case 'P':
+    {
+        Pig *p = new Pig(body, record.radius);
+        fixture_def.userData.pointer = reinterpret_cast<uintptr_t>(p);
+        objects_.push_back(std::unique_ptr<Object>(p));
+        break;
+    }
+    default:
+    {
+        b2Vec2 dimensions = utils::DimensionsFromPolygon(&polygon);
+        Wall *w = new Wall(body, dimensions.x, dimensions.y);
+        fixture_def.userData.pointer = reinterpret_cast<uintptr_t>(w);
+        objects_.push_back(std::unique_ptr<Object>(w));
+        break;
+    }
+    }
+
+    body->CreateFixture(&fixture_def);
+    if (IsBirdType(record.type))
+    {
+        bird_id_ = id;
+        return nullptr;
+    }
+    objects_.back()->SetId(id);
+    return objects_.back().get();
 }
 
 void Level::ThrowBird(int angle, b2Vec2 velocity)
@@ -231,6 +304,13 @@ void Level::ThrowBird(int angle, b2Vec2 velocity)
     }
 }
 
+b2Vec2 Level::ThrowImpulse(float direction, float power)
+{
+    float x = cos(utils::DegreesToRadians(direction)) * power / 20;
+    float y = sin(utils::DegreesToRadians(direction)) * power / 20;
+    return b2Vec2(x, y);
+}
+
 void Level::ResetBird()
 {
 
@@ -245,71 +325,327 @@ void Level::ResetBird()
     b2Body *body = GetBird()->GetBody();
     body->SetGravityScale(0);
     body->SetTransform(bird_starting_position, 0);
+    body->SetEnabled(true);
 }
 
-bool ObjectRemover(Object *obj)
+bool Level::Step()
 {
-    return obj->IsDestroyed();
+    if (++steps_since_streaming_ >= streaming_interval)
+    {
+        steps_since_streaming_ = 0;
+        StreamChunks();
+    }
+    GetBird()->UsePower();
+    world_->Step(time_step, velocity_iterations, position_iterations);
+    FollowMovedBodies();
+    particles_.Update(time_step);
+    return Update();
 }
 
-bool Level::DrawLevel(sf::RenderWindow &window)
+void Level::FollowMovedBodies()
 {
-    // Draw slingshot
-    sf::RectangleShape slingshot(sf::Vector2f(100.0f, 100.0f));
-    sf::Vector2f slingshot_center = utils::B2ToSfCoords(bird_starting_position);
-    sf::Texture slingshot_texture;
-    slingshot_texture.loadFromFile("resources/images/slingshot.png");
-    slingshot.setTexture(&slingshot_texture);
-    slingshot.setScale(1, 1.5f);
-    slingshot.setOrigin(50, 30);
-    slingshot.setPosition(slingshot_center);
-    window.draw(slingshot);
-
-    for (b2Contact *ce = world_->GetContactList(); ce; ce = ce->GetNext())
+    for (const BodyMove &move : world_->GetMovedBodies())
     {
-        b2Contact *c = ce;
+        // All birds share one body, every other object has its own and is found through the fixture
+        if (move.from == GetBird()->GetBody())
+        {
+            for (const auto &bird : birds_)
+            {
+                bird->SetBody(move.to);
+            }
+        }
+        else
+        {
+            Object *object = reinterpret_cast<Object *>(move.to->GetFixtureList()->GetUserData().pointer);
+            object->SetBody(move.to);
+        }
+    }
+}
 
-        Object *objA = reinterpret_cast<Object *>(c->GetFixtureA()->GetUserData().pointer);
-        Object *objB = reinterpret_cast<Object *>(c->GetFixtureB()->GetUserData().pointer);
+bool Level::IsChunkActive(int32_t chunk, float extra) const
+{
+    float left = chunk * chunk_width;
+    float right = left + chunk_width;
+    return right >= active_left_ - chunk_margin - extra && left <= active_right_ + chunk_margin + extra;
+}
 
-        score_ = score_ + objA->TryToDestroy(objB->GetBody()->GetLinearVelocity().Length());
-        score_ = score_ + objB->TryToDestroy(objA->GetBody()->GetLinearVelocity().Length());
+void Level::StreamChunks()
+{
+    active_left_ = focus_left_;
+    active_right_ = focus_right_;
+    b2Body *bird = GetBird()->GetBody();
+    b2Vec2 position = bird->GetPosition();
+    b2Vec2 ahead = position + path_lookahead * bird->GetLinearVelocity();
+    active_left_ = std::min(active_left_, std::min(position.x, ahead.x));
+    active_right_ = std::max(active_right_, std::max(position.x, ahead.x));
+
+    for (auto it = dormant_chunks_.begin(); it != dormant_chunks_.end();)
+    {
+        if (!IsChunkActive(it->first))
+        {
+            ++it;
+            continue;
+        }
+        for (const auto &dormant : it->second)
+        {
+            Object *object = AddBody(dormant.id, dormant.record, "");
+            object->SetDThreshold(dormant.health);
+            dormant_pigs_ -= dormant.record.type == 'P';
+            if (dormant.record.body_type == b2_staticBody)
+            {
+                MarkStaticUpdate(*object);
+            }
+        }
+        it = dormant_chunks_.erase(it);
     }
 
-    for (auto ob : objects_)
+    // A chunk is unloaded a chunk width further out than it is loaded, and only when
+    // nothing in it moves, so bodies don't get frozen in the air or flicker in and out
+    auto chunk_of = [](Object &object)
     {
-        if (ob->IsDestroyed())
+        return level_asset::ChunkAt(object.GetType(), object.GetBody()->GetPosition(), 2 * object.GetHalfSize().x);
+    };
+    std::map<int32_t, bool> resting;
+    for (const auto &object : objects_)
+    {
+        int32_t chunk = chunk_of(*object);
+        if (chunk == resident_chunk || IsChunkActive(chunk, chunk_width))
         {
-            if (Pig *p = dynamic_cast<Pig *>(ob))
+            continue;
+        }
+        bool &chunk_resting = resting.insert(std::make_pair(chunk, true)).first->second;
+        chunk_resting = chunk_resting && !object->GetBody()->IsAwake();
+    }
+
+    // A chunk also stays while bodies that stay loaded stand on it, e.g. a tower on a platform
+    // reaching into the next chunk, or they would fall through once it is gone. Keeping a chunk
+    // keeps its bodies loaded too, so this goes on until nothing changes.
+    auto unloading = [&resting, &chunk_of](Object &object)
+    {
+        auto chunk = resting.find(chunk_of(object));
+        return chunk != resting.end() && chunk->second;
+    };
+    bool kept = true;
+    while (kept)
+    {
+        kept = false;
+        for (const auto &object : objects_)
+        {
+            b2Body *body = object->GetBody();
+            if (body->GetType() == b2_staticBody || unloading(*object))
             {
-                p->MakeSound();
+                continue;
             }
-            else
+            for (b2ContactEdge *edge = body->GetContactList(); edge; edge = edge->next)
             {
-                ob->MakeSound();
+                Object *other = reinterpret_cast<Object *>(edge->other->GetFixtureList()->GetUserData().pointer);
+                if (edge->contact->IsTouching() && unloading(*other))
+                {
+                    resting[chunk_of(*other)] = false;
+                    kept = true;
+                }
             }
-            world_->DestroyBody(ob->GetBody());
         }
     }
+    for (auto it = objects_.begin(); it != objects_.end();)
+    {
+        Object &object = **it;
+        auto chunk = resting.find(chunk_of(object));
+        if (chunk == resting.end() || !chunk->second)
+        {
+            ++it;
+            continue;
+        }
+        b2Body *body = object.GetBody();
+        dormant_chunks_[chunk->first].push_back({object.GetId(), object.GetDThreshold(), level_asset::MakeRecord(object.GetType(), body)});
+        dormant_pigs_ += object.GetType() == 'P';
+        if (body->GetType() == b2_staticBody)
+        {
+            MarkStaticUpdate(object);
+        }
+        world_->DestroyBody(body);
+        it = objects_.erase(it);
+    }
+}
+
+bool Level::IsInBounds(const b2Vec2 &position) const
+{
+    return position.x >= bounds_.lowerBound.x && position.x <= bounds_.upperBound.x &&
+           position.y >= bounds_.lowerBound.y && position.y <= bounds_.upperBound.y;
+}
+
+size_t Level::CountDormantBodies() const
+{
+    size_t count = 0;
+    for (const auto &chunk : dormant_chunks_)
+    {
+        count += chunk.second.size();
+    }
+    return count;
+}
 
-    objects_.remove_if(ObjectRemover);
+bool Level::Advance(int max_steps, int *steps_taken)
+{
+    bool moving = true;
+    int steps = 0;
+    while (moving && steps < max_steps)
+    {
+        moving = Step();
+        steps++;
+    }
+    if (steps_taken)
+    {
+        *steps_taken = steps;
+    }
+    return moving;
+}
+
+void Level::EmitDebris(Object &object)
+{
+    // Roughly one piece per 20x20 pixels of the object
+    b2Vec2 half_size = object.GetHalfSize();
+    sf::Vector2f center = utils::B2ToSfCoords(object.GetBody()->GetPosition());
+    float w = half_size.x * 2 * scale;
+    float h = half_size.y * 2 * scale;
+    int count = std::max(8, std::min(48, static_cast<int>(w * h / 400)));
+
+    sf::Color color(150, 110, 60); // Wood
+    if (object.GetType() == 'P')
+    {
+        color = sf::Color(110, 190, 60);
+    }
+    particles_.Emit(sf::FloatRect(center.x - w / 2, center.y - h / 2, w, h), color, count);
+}
+
+bool Level::Update()
+{
+    world_->ForEachContact([this](b2Contact *c)
+                           {
+                               Object *objA = reinterpret_cast<Object *>(c->GetFixtureA()->GetUserData().pointer);
+                               Object *objB = reinterpret_cast<Object *>(c->GetFixtureB()->GetUserData().pointer);
+
+                               score_ = score_ + objA->TryToDestroy(objB->GetBody()->GetLinearVelocity().Length());
+                               score_ = score_ + objB->TryToDestroy(objA->GetBody()->GetLinearVelocity().Length()); });
+
+    // Bodies that left the play area are gone for good, without sound or debris since nobody sees them
+    for (auto it = objects_.begin(); it != objects_.end();)
+    {
+        b2Body *body = (*it)->GetBody();
+        if (body->GetType() != b2_staticBody && !IsInBounds(body->GetPosition()))
+        {
+            score_ += (*it)->Destroy();
+            culled_count_++;
+            world_->DestroyBody(body);
+            it = objects_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    // Sounds play on shared voices so destroyed objects can be freed right away
+    for (auto it = objects_.begin(); it != objects_.end();)
+    {
+        Object *ob = it->get();
+        if (ob->IsDestroyed())
+        {
+            ob->MakeSound();
+            if (ob->GetBody()->GetType() == b2_staticBody)
+            {
+                MarkStaticUpdate(*ob);
+            }
+            EmitDebris(*ob);
+            world_->DestroyBody(ob->GetBody());
+            it = objects_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
     if (CountPigs() == 0 &&
         !IsLevelEnded())
     {
         level_ended_ = true;
         score_ = score_ + (static_cast<int>(birds_.size()) - 1) * 1000;
     }
-    // Draw box2d objects
+
     bool moving = false;
-    for (auto it : objects_)
+    for (const auto &it : objects_)
+    {
+        moving = moving || it->GetBody()->IsAwake();
+    }
+
+    // The bird's body is shared by all birds so it's only taken out of the simulation
+    b2Body *body = GetBird()->GetBody();
+    if (body->IsEnabled() && !IsInBounds(body->GetPosition()))
+    {
+        body->SetLinearVelocity(b2Vec2(0, 0));
+        body->SetAngularVelocity(0.f);
+        body->SetEnabled(false);
+        culled_count_++;
+    }
+    if (!body->IsEnabled())
+    {
+        return moving;
+    }
+
+    return moving || body->IsAwake();
+}
+
+void Level::Draw(sf::RenderTarget &target)
+{
+    PrepareBatches();
+    for (const auto &sprite : unbatched_)
+    {
+        target.draw(sprite);
+    }
+    const TextureAtlas &atlas = TextureAtlas::Get();
+    for (int i = 0; i < atlas.GetPageCount(); i++)
+    {
+        target.draw(batches_[i], &atlas.GetTexture(i));
+    }
+    particles_.Draw(target);
+}
+
+void Level::PrepareBatches()
+{
+    // Sprites from the atlas are collected into one vertex array per atlas page,
+    // everything else is kept aside to be drawn on its own
+    const TextureAtlas &atlas = TextureAtlas::Get();
+    batches_.resize(atlas.GetPageCount(), sf::VertexArray(sf::Quads));
+    for (auto &batch : batches_)
+    {
+        batch.clear();
+    }
+    unbatched_.clear();
+    auto add_sprite = [&](const sf::Sprite &sprite)
+    {
+        int page = atlas.PageOf(sprite.getTexture());
+        if (page < 0)
+        {
+            unbatched_.push_back(sprite);
+        }
+        else
+        {
+            utils::AppendQuad(batches_[page], sprite);
+        }
+    };
+
+    // Box2d objects, static ones are in the static layer
+    for (const auto &it : objects_)
     {
         b2Body *body = it->GetBody();
+        if (body->GetType() == b2_staticBody)
+        {
+            continue;
+        }
         b2Vec2 pos = body->GetPosition();
         sf::Sprite sprite = it->GetSprite();
         sprite.setPosition(utils::B2ToSfCoords(pos));
         sprite.setRotation(utils::RadiansToDegrees(body->GetAngle()) * -1.0f);
-        window.draw(sprite);
-        moving = moving || body->IsAwake();
+        add_sprite(sprite);
     }
 
     b2Body *body = GetBird()->GetBody();
@@ -317,21 +653,55 @@ bool Level::DrawLevel(sf::RenderWindow &window)
     sf::Sprite sprite = GetBird()->GetSprite();
     sprite.setPosition(utils::B2ToSfCoords(pos));
     sprite.setRotation(utils::RadiansToDegrees(-body->GetAngle()));
-    window.draw(sprite);
+    add_sprite(sprite);
+}
 
-    bool birdOutOfBounds = !(pos.x < (viewwidth * 1.5f) / scale && pos.x > -1);
+void Level::DrawStatic(sf::RenderTarget &target) const
+{
+    target.draw(SlingshotSprite());
+    for (const auto &it : objects_)
+    {
+        b2Body *body = it->GetBody();
+        if (body->GetType() == b2_staticBody)
+        {
+            target.draw(StaticSprite(*it));
+        }
+    }
+}
 
-    if (birdOutOfBounds)
+bool Level::TakeStaticUpdate(sf::FloatRect &area)
+{
+    if (!has_static_update_)
     {
-        body->SetLinearVelocity(b2Vec2(0, 0));
-        body->SetAngularVelocity(0.f);
-        return false || moving;
+        return false;
     }
+    area = static_update_;
+    has_static_update_ = false;
+    return true;
+}
 
-    return moving || body->IsAwake();
+void Level::MarkStaticUpdate(Object &object)
+{
+    // Runs headless in the simulator and the tests as well, so no sprite is built here
+    sf::FloatRect bounds = Footprint(object);
+    static_update_ = has_static_update_ ? Union(static_update_, bounds) : bounds;
+    has_static_update_ = true;
+}
+
+sf::FloatRect Level::GetStaticBounds() const
+{
+    sf::FloatRect bounds = SlingshotSprite().getGlobalBounds();
+    for (const auto &it : objects_)
+    {
+        if (it->GetBody()->GetType() == b2_staticBody)
+        {
+            bounds = Union(bounds, StaticSprite(*it).getGlobalBounds());
+        }
+    }
+    return bounds;
 }
 
-std::tuple<float, float> Level::DrawArrow(sf::RenderWindow &window)
+std::tuple<float, float> Level::DrawArrow(const sf::RenderWindow &window, sf::RenderTarget &target)
 {
     sf::Vector2f mouse_position = window.mapPixelToCoords(sf::Mouse::getPosition(window));
     sf::Vector2f slingshot_center = utils::B2ToSfCoords(bird_starting_position);
@@ -362,12 +732,12 @@ std::tuple<float, float> Level::DrawArrow(sf::RenderWindow &window)
         line.setFillColor(sf::Color(0, 0, 0));
         line.setPosition(slingshot_center.x, slingshot_center.y);
         line.setRotation(180 + rotation);
-        window.draw(line);
+        target.draw(line);
         line.setSize(sf::Vector2f(length / 3, 4));
         line.setRotation(150 + rotation);
-        window.draw(line);
+        target.draw(line);
         line.setRotation(210 + rotation);
-        window.draw(line);
+        target.draw(line);
         return {direction, length};
     }
     else
@@ -378,29 +748,185 @@ std::tuple<float, float> Level::DrawArrow(sf::RenderWindow &window)
 
 void Level::SaveState(std::ofstream &file)
 {
-    // Write level name to first line
-    file << name_ << std::endl;
-    // Write highscores on second line
-    for (auto high_score : high_scores_)
+    level_asset::WriteText(file, Snapshot());
+}
+
+LevelAsset Level::Snapshot()
+{
+    LevelAsset asset;
+    asset.name = name_;
+    asset.number = level_number_;
+    asset.high_scores = high_scores_;
+    asset.score = score_;
+    for (const auto &bird : birds_)
+    {
+        asset.birds += bird->GetType();
+    }
+    asset.bodies.reserve(objects_.size() + CountDormantBodies() + 1);
+    // The bird first, then all the other objects
+    asset.bodies.push_back(level_asset::MakeRecord(GetBird()->GetType(), GetBird()->GetBody()));
+    for (const auto &obj : objects_)
+    {
+        asset.bodies.push_back(level_asset::MakeRecord(obj->GetType(), obj->GetBody()));
+        asset.bodies.back().damage = FullHealth(obj->GetType()) - obj->GetDThreshold();
+    }
+    for (const auto &chunk : dormant_chunks_)
+    {
+        for (const auto &dormant : chunk.second)
+        {
+            asset.bodies.push_back(dormant.record);
+            asset.bodies.back().damage = FullHealth(dormant.record.type) - dormant.health;
+        }
+    }
+    int i = 0;
+    for (auto threshold : star_tresholds_)
+    {
+        asset.star_thresholds[i++] = threshold;
+    }
+    asset.pig_count = CountPigs();
+    level_asset::SortIntoChunks(asset);
+    return asset;
+}
+
+namespace
+{
+    BodyState MakeState(uint32_t id, const b2Body *body, float health)
+    {
+        BodyState state;
+        std::memset(static_cast<void *>(&state), 0, sizeof state);
+        state.id = id;
+        state.position = body->GetPosition();
+        state.angle = body->GetAngle();
+        state.linear_velocity = body->GetLinearVelocity();
+        state.angular_velocity = body->GetAngularVelocity();
+        state.gravity_scale = body->GetGravityScale();
+        state.health = health;
+        state.awake = body->IsAwake();
+        state.enabled = body->IsEnabled();
+        return state;
+    }
+}
+
+LevelState Level::CaptureState()
+{
+    LevelState state;
+    state.bodies.reserve(objects_.size() + CountDormantBodies() + 1);
+    state.bodies.push_back(MakeState(bird_id_, GetBird()->GetBody(), 0));
+    for (const auto &obj : objects_)
+    {
+        state.bodies.push_back(MakeState(obj->GetId(), obj->GetBody(), obj->GetDThreshold()));
+    }
+    for (const auto &chunk : dormant_chunks_)
+    {
+        for (const auto &dormant : chunk.second)
+        {
+            BodyState body;
+            std::memset(static_cast<void *>(&body), 0, sizeof body);
+            body.id = dormant.id;
+            body.position = dormant.record.position;
+            body.angle = dormant.record.angle;
+            body.linear_velocity = dormant.record.linear_velocity;
+            body.angular_velocity = dormant.record.angular_velocity;
+            body.gravity_scale = dormant.record.gravity_scale;
+            body.health = dormant.health;
+            body.awake = dormant.record.awake != 0;
+            body.enabled = 1;
+            state.bodies.push_back(body);
+        }
+    }
+    std::sort(state.bodies.begin(), state.bodies.end(), [](const BodyState &a, const BodyState &b)
+              { return a.id < b.id; });
+
+    for (const auto &bird : birds_)
+    {
+        state.birds += bird->GetType();
+    }
+    state.bird_power_left = GetBird()->GetPowerLeft();
+    state.bird_power_used = GetBird()->IsPowerUsed();
+    state.bird_thrown = GetBird()->IsThrown();
+    state.score = score_;
+    state.level_ended = level_ended_;
+    state.culled_count = culled_count_;
+    return state;
+}
+
+void Level::RestoreState(const LevelState &state)
+{
+    // The baked static layer only has to be redone if other static bodies are loaded afterwards
+    auto static_ids = [this]()
+    {
+        std::vector<uint32_t> ids;
+        for (const auto &object : objects_)
+        {
+            if (object->GetBody()->GetType() == b2_staticBody)
+            {
+                ids.push_back(object->GetId());
+            }
+        }
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    };
+    std::vector<uint32_t> static_before = static_ids();
+
+    // Everything is created again in a fresh world, which for a level is a matter of microseconds
+    birds_.clear();
+    objects_.clear();
+    dormant_chunks_.clear();
+    dormant_pigs_ = 0;
+    world_ = PhysicsWorld::Create(backend_, gravity);
+    particles_.Clear();
+
+    // Chunks around the view and the restored bird are loaded, the rest stay records like in StreamChunks
+    active_left_ = focus_left_;
+    active_right_ = focus_right_;
+    for (const auto &body : state.bodies)
     {
-        file << std::get<0>(high_score) << ":" << std::get<1>(high_score) << ";";
+        if (body.id == bird_id_)
+        {
+            active_left_ = std::min(active_left_, body.position.x);
+            active_right_ = std::max(active_right_, body.position.x);
+        }
     }
-    file << std::endl;
-    // Write available birds on the third line
-    for (auto bird : birds_)
+
+    for (const auto &body : state.bodies)
     {
-        file << bird->GetType();
+        if (body.id >= originals_.size())
+        {
+            continue;
+        }
+        BodyRecord record = originals_[body.id];
+        record.position = body.position;
+        record.angle = body.angle;
+        record.linear_velocity = body.linear_velocity;
+        record.angular_velocity = body.angular_velocity;
+        record.gravity_scale = body.gravity_scale;
+        record.awake = body.awake;
+        int32_t chunk = level_asset::ChunkOf(record);
+        if (chunk != resident_chunk && !IsChunkActive(chunk))
+        {
+            dormant_chunks_[chunk].push_back({body.id, body.health, record});
+            dormant_pigs_ += record.type == 'P';
+            continue;
+        }
+        Object *object = AddBody(body.id, record, state.birds);
+        if (object)
+        {
+            object->SetDThreshold(body.health);
+        }
+        else
+        {
+            GetBird()->GetBody()->SetEnabled(body.enabled != 0);
+        }
     }
-    file << std::endl;
-    // Save bird to second line
-    GetBird()->SaveState(file);
-    file << std::endl;
-    // Then save all the other objects
-    for (auto obj : objects_)
+    if (static_ids() != static_before)
     {
-        obj->SaveState(file);
-        file << std::endl;
+        static_changes_++;
     }
+    GetBird()->Restore(state.bird_power_left, state.bird_power_used, state.bird_thrown);
+    score_ = state.score;
+    level_ended_ = state.level_ended;
+    culled_count_ = state.culled_count;
+    steps_since_streaming_ = 0;
 }
 
 std::tuple<std::string, int> Level::GetHighScore()
@@ -430,5 +956,17 @@ std::list<std::tuple<std::string, int>> Level::UpdateHighScore(std::string nickn
     {
         high_scores_.push_back({nickname, score_});
     }
+    UpdateScores();
     return high_scores_;
+}
+
+void Level::UpdateScores()
+{
+    static std::atomic<unsigned> next_revision(1); // Levels may be loaded on several threads
+    std::list<std::tuple<std::string, int>> sorted = high_scores_;
+    sorted.sort(utils::CmpHighScore);
+    sorted.reverse();
+    scores_.level_number = level_number_;
+    scores_.entries.assign(sorted.begin(), sorted.end());
+    scores_.revision = next_revision++;
 }
\ No newline at end of file
@@ -10,23 +10,77 @@
 #include <SFML/Graphics.hpp>
 #include "bird.hpp"
 #include "converters.hpp"
+#include "level_asset.hpp"
+#include "particles.hpp"
+#include "physics_world.hpp"
 #include <iostream>
 #include <tuple>
 #include <map>
+#include <memory>
+
+// Compact high score list of a single level, best score first
+struct LevelScores
+{
+    int level_number = 0;
+    std::vector<std::tuple<std::string, int>> entries;
+    unsigned revision = 0; // Unique for every version of the list, changes whenever the scores change
+};
+
+// A body of an unloaded chunk
+struct DormantBody
+{
+    uint32_t id;
+    float health; // Destruction threshold left
+    BodyRecord record;
+};
+
+// Dynamic state of one body, everything else comes from the level asset
+struct BodyState
+{
+    uint32_t id; // Index of the body in the level asset
+    b2Vec2 position;
+    float angle;
+    b2Vec2 linear_velocity;
+    float angular_velocity;
+    float gravity_scale; // Only changes for the bird
+    float health;        // Destruction threshold left
+    uint8_t awake;
+    uint8_t enabled;
+};
+
+// Everything that changes while a level is played. Bodies missing from the list have been destroyed.
+struct LevelState
+{
+    std::vector<BodyState> bodies; // Sorted by id
+    std::string birds;             // Bird types left, the one on the slingshot or in flight first
+    int bird_power_left = 0;
+    bool bird_power_used = false;
+    bool bird_thrown = false;
+    int score = 0;
+    bool level_ended = false;
+    int culled_count = 0;
+};
 
 class Level
 {
 public:
     Level();
-    Level(std::ifstream &file);
+    Level(std::istream &file, PhysicsBackend backend = PhysicsBackend::Box2D);
+    Level(const LevelAsset &asset, PhysicsBackend backend = PhysicsBackend::Box2D);
+
+    // A level owns its world and objects so it can only be moved
+    Level(const Level &) = delete;
+    Level &operator=(const Level &) = delete;
+    Level(Level &&) = default;
+    Level &operator=(Level &&) = default;
 
     std::string GetName() const { return name_; }
 
-    b2World *GetWorld() { return world_; }
+    PhysicsWorld *GetWorld() { return world_.get(); }
 
-    std::list<Object *> objects() { return objects_; }
+    std::list<Object *> objects();
 
-    Bird *GetBird() { return birds_.front(); }
+    Bird *GetBird() { return birds_.front().get(); }
 
     int GetScore() { return score_; }
 
@@ -34,12 +88,17 @@ public:
 
     std::list<std::tuple<std::string, int>> GetHighScores() { return high_scores_; }
 
+    const LevelScores &GetScores() const { return scores_; }
+
     int GetLevelNumber() { return level_number_; }
 
     std::list<std::tuple<std::string, int>> UpdateHighScore(std::string nickname);
 
     void ThrowBird(int angle, b2Vec2 velocity);
 
+    // Impulse of a throw aimed with the arrow, direction in degrees and power 0-100
+    static b2Vec2 ThrowImpulse(float direction, float power);
+
     std::vector<int> CountBirdTypes();
 
     int CountPigs();
@@ -48,14 +107,80 @@ public:
 
     bool IsLevelEnded() { return level_ended_; }
 
+    // Advances the simulation by one time step and updates the game state.
+    // Returns true if world hasn't settled yet
+    bool Step();
+
+    // Runs Step up to max_steps times, stopping as soon as the world settles.
+    // Used by fast-forward and headless runs so they step exactly like normal play.
+    // Returns true if world hasn't settled yet
+    bool Advance(int max_steps, int *steps_taken = nullptr);
+
+    // Applies contact damage, removes destroyed objects and checks if the level has ended.
     // Returns true if world hasn't settled yet
-    bool DrawLevel(sf::RenderWindow &window);
+    bool Update();
+
+    // Draws the moving bodies, see DrawStatic for the rest
+    void Draw(sf::RenderTarget &target);
+
+    // Builds the vertex arrays Draw draws, one per atlas page. Separate so it can be timed without a window.
+    void PrepareBatches();
 
+    // Draws the slingshot and static bodies, meant to be baked into a StaticLayer
+    void DrawStatic(sf::RenderTarget &target) const;
+
+    // Area DrawStatic draws into, in pixels
+    sf::FloatRect GetStaticBounds() const;
+
+    // Part of the world the player is looking at, in meters. Chunks around it and around
+    // the bird's path stay loaded, chunks further away are unloaded once they come to rest.
+    void SetFocus(float left, float right)
+    {
+        focus_left_ = left;
+        focus_right_ = right;
+    }
+
+    // Position of the rightmost body in meters, loaded or not
+    float GetWorldRight() const { return world_right_; }
+
+    // Bodies kept as records in unloaded chunks
+    size_t CountDormantBodies() const;
+
+    // Play area in meters. A body that leaves it is removed from the world: pigs and
+    // walls count as destroyed and score their points, the bird is disabled until the
+    // next bird is put on the slingshot. Defaults to the area the camera can show.
+    void SetBounds(const b2AABB &bounds) { bounds_ = bounds; }
+    const b2AABB &GetBounds() const { return bounds_; }
+
+    // Bodies removed for leaving the play area
+    int GetCulledCount() const { return culled_count_; }
+
+    // Debris is still flying even though the world may have settled
+    bool HasParticles() const { return particles_.GetCount() > 0; }
+
+    // Grows whenever the static bodies are replaced as a whole and the static layer has to be rebuilt
+    unsigned GetStaticChanges() const { return static_changes_; }
+
+    // Area in pixels where static bodies were destroyed, loaded or unloaded since the last call.
+    // Only the static layer tiles there have to be baked again. Returns false if nothing changed.
+    bool TakeStaticUpdate(sf::FloatRect &area);
+
+    // Aims with the mouse in the window and draws the arrow into target.
     // Returns { direction, power } of the arrow
-    std::tuple<float, float> DrawArrow(sf::RenderWindow &window);
+    std::tuple<float, float> DrawArrow(const sf::RenderWindow &window, sf::RenderTarget &target);
 
     void SaveState(std::ofstream &file);
 
+    // Copies the state of every body into memory, cheap enough to call between frames
+    LevelAsset Snapshot();
+
+    // Compact copy of the changing state, for rewinding
+    LevelState CaptureState();
+
+    // Rebuilds the world from a captured state without reading the level file. Works on any
+    // level created from the same asset, so a state can also be branched into a new level.
+    void RestoreState(const LevelState &state);
+
     int GetStars()
     {
         return std::count_if(star_tresholds_.begin(), star_tresholds_.end(), [this](int i)
@@ -63,15 +188,55 @@ public:
     }
 
 private:
+    bool IsInBounds(const b2Vec2 &position) const;
+
+    // Creates the body, its fixture and the object owning it. Bird bodies get one bird per type in birds
+    // and return nullptr, everything else returns the new object.
+    Object *AddBody(uint32_t id, const BodyRecord &record, const std::string &birds);
+
+    // Is the chunk within the loaded range, widened by extra meters
+    bool IsChunkActive(int32_t chunk, float extra = 0) const;
+
+    // Loads the chunks that came into range and unloads the resting ones that left it
+    void StreamChunks();
+
+    // Points the objects whose bodies the world recreated during the last step to the new ones
+    void FollowMovedBodies();
+
+    void UpdateScores();
+    void EmitDebris(Object &object);
+    void MarkStaticUpdate(Object &object);
+
     std::string name_;
-    std::list<Bird *> birds_;
-    b2World *world_;
-    std::list<Object *> objects_;
+    PhysicsBackend backend_ = PhysicsBackend::Box2D;
+    std::unique_ptr<PhysicsWorld> world_;
+    std::list<std::unique_ptr<Bird>> birds_;
+    std::list<std::unique_ptr<Object>> objects_;
     int score_ = 0;
     std::list<std::tuple<std::string, int>> high_scores_;
+    LevelScores scores_;
     bool level_ended_ = false;
     int level_number_;
     std::list<int> star_tresholds_;
+    std::vector<sf::VertexArray> batches_; // Reused between frames to avoid reallocating
+    std::vector<sf::Sprite> unbatched_;    // Sprites outside the atlas, drawn one by one
+    unsigned static_changes_ = 0;
+    sf::FloatRect static_update_; // See TakeStaticUpdate
+    bool has_static_update_ = false;
+    ParticleSystem particles_;
+
+    std::map<int32_t, std::vector<DormantBody>> dormant_chunks_; // Unloaded chunks as plain records
+    int dormant_pigs_ = 0;
+    float focus_left_ = 0;
+    float focus_right_ = viewwidth / scale;
+    float active_left_ = 0; // Loaded range in meters, without the margin
+    float active_right_ = viewwidth / scale;
+    float world_right_ = 0;
+    int steps_since_streaming_ = 0;
+    b2AABB bounds_;
+    int culled_count_ = 0;
+    std::vector<BodyRecord> originals_; // The asset's bodies, indexed by id
+    uint32_t bird_id_ = 0;
 };
 
 #endif // ANGRY_BIRDS_LEVEL
\ No newline at end of file
@@ -0,0 +1,524 @@
+#include "level_asset.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+namespace
+{
+    const char binary_magic[4] = {'A', 'B', 'L', '2'};
+
+    bool IsBird(char type)
+    {
+        return type == 'B' || type == 'D' || type == 'S';
+    }
+
+    BodyRecord EmptyRecord()
+    {
+        BodyRecord record;
+        // Clear the padding too so compiled assets are reproducible
+        std::memset(static_cast<void *>(&record), 0, sizeof record);
+        b2Vec2 zero(0, 0);
+        record.type = 0;
+        record.body_type = b2_staticBody;
+        record.position = record.linear_velocity = record.center = zero;
+        record.angle = record.angular_velocity = record.angular_damping = record.linear_damping = 0;
+        record.gravity_scale = 1;
+        record.awake = 1;
+        record.shape_type = b2Shape::Type::e_circle;
+        record.radius = 0;
+        record.vertex_count = 0;
+        for (int i = 0; i < b2_maxPolygonVertices; i++)
+        {
+            record.vertices[i] = record.normals[i] = zero;
+        }
+        record.density = record.friction = record.restitution = 0;
+        record.damage = 0;
+        return record;
+    }
+
+    // Parses "T;body;fixture;" row, returns an empty string on success
+    std::string ParseBody(const std::string &line, BodyRecord &record)
+    {
+        std::stringstream row(line);
+        char _; // character dump
+        b2BodyType body_type = b2_staticBody;
+        bool awake = true;
+
+        row.get(record.type);
+        row.ignore(); // Ignore the following separator
+        row >> record.position >> _ >> record.angle >> _ >> record.angular_velocity >> _ >> record.linear_velocity >> _ >> record.angular_damping >> _ >> record.linear_damping >> _ >> record.gravity_scale >> _ >> body_type >> _ >> awake >> _;
+        record.body_type = body_type;
+        record.awake = awake;
+        if (!row)
+        {
+            return "malformed body";
+        }
+
+        row >> record.shape_type >> _;
+        switch (record.shape_type)
+        {
+        case b2Shape::Type::e_circle:
+            row >> record.center >> _ >> record.radius >> _;
+            break;
+        case b2Shape::Type::e_polygon:
+        {
+            // Vertices and normals past the vertex count are uninitialized memory in the file, they are dropped
+            b2Vec2 vertices[8], normals[8];
+            row >> record.center >> _;
+            for (int i = 0; i < 8; i++)
+            {
+                row >> vertices[i] >> _;
+            }
+            for (int i = 0; i < 8; i++)
+            {
+                row >> normals[i] >> _;
+            }
+            row >> record.vertex_count >> _ >> record.radius >> _;
+            if (record.vertex_count < 3 || record.vertex_count > b2_maxPolygonVertices)
+            {
+                return "polygon with " + std::to_string(record.vertex_count) + " vertices";
+            }
+            for (int i = 0; i < record.vertex_count; i++)
+            {
+                record.vertices[i] = vertices[i];
+                record.normals[i] = normals[i];
+            }
+            break;
+        }
+        default:
+            return "unknown shape type " + std::to_string(record.shape_type);
+        }
+
+        row >> record.density >> _ >> record.friction >> _ >> record.restitution >> _;
+        if (!row)
+        {
+            return "malformed fixture";
+        }
+        // Saves add the damage taken, level files leave it out
+        if (!(row >> record.damage))
+        {
+            record.damage = 0;
+        }
+
+        switch (record.type)
+        {
+        case 'B':
+        case 'D':
+        case 'S':
+        case 'P':
+            if (record.shape_type != b2Shape::Type::e_circle)
+            {
+                return "object must be a circle";
+            }
+            break;
+        case 'W':
+            if (record.shape_type != b2Shape::Type::e_polygon)
+            {
+                return "wall must be a polygon";
+            }
+            break;
+        case 'G':
+            break;
+        default:
+            return std::string("unknown object code '") + record.type + "'";
+        }
+        return "";
+    }
+
+    void WriteString(std::ostream &output, const std::string &str)
+    {
+        uint32_t length = static_cast<uint32_t>(str.size());
+        output.write(reinterpret_cast<const char *>(&length), sizeof length);
+        output.write(str.data(), length);
+    }
+
+    // Reads plain values from a memory block, fails instead of reading past the end
+    class BlockReader
+    {
+    public:
+        BlockReader(const char *data, size_t size) : data_(data), left_(size) {}
+
+        bool Read(void *value, size_t size)
+        {
+            if (size > left_)
+            {
+                return false;
+            }
+            std::memcpy(value, data_, size);
+            data_ += size;
+            left_ -= size;
+            return true;
+        }
+
+        bool ReadString(std::string &str)
+        {
+            uint32_t length;
+            if (!Read(&length, sizeof length) || length > left_)
+            {
+                return false;
+            }
+            str.assign(data_, length);
+            data_ += length;
+            left_ -= length;
+            return true;
+        }
+
+    private:
+        const char *data_;
+        size_t left_;
+    };
+}
+
+namespace level_asset
+{
+    LevelAsset Parse(std::istream &input, std::vector<std::string> &errors)
+    {
+        LevelAsset asset;
+        std::string text((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        asset.source_hash = ContentHash(text);
+
+        std::stringstream file(text);
+        std::string line;
+
+        // Level name on the first line, "Level <number>"
+        std::getline(file, asset.name);
+        if (!asset.name.empty() && asset.name.back() == '\r')
+        {
+            asset.name.pop_back();
+        }
+        std::stringstream name(asset.name.size() > 5 ? asset.name.substr(5) : "");
+        if (asset.name.compare(0, 6, "Level ") != 0 || !(name >> asset.number))
+        {
+            errors.push_back("line 1: level name must be \"Level <number>\", got \"" + asset.name + "\"");
+        }
+
+        // High scores on the second line
+        std::getline(file, line);
+        asset.high_scores = ParseHighScores(line);
+
+        // Bird list on the third line
+        std::getline(file, line);
+        for (auto type : line)
+        {
+            if (IsBird(type))
+            {
+                asset.birds += type;
+            }
+            else if (type != '\r')
+            {
+                errors.push_back(std::string("line 3: unknown bird type '") + type + "'");
+            }
+        }
+        if (asset.birds.empty())
+        {
+            errors.push_back("line 3: level has no birds");
+        }
+
+        // One body per line after that
+        int line_number = 3;
+        int bird_bodies = 0;
+        while (std::getline(file, line))
+        {
+            line_number++;
+            if (line.empty() || line == "\r")
+            {
+                continue;
+            }
+            // Saves store the score reached so far on its own line
+            if (line.compare(0, 6, "score;") == 0)
+            {
+                asset.score = std::atoi(line.c_str() + 6);
+                continue;
+            }
+            BodyRecord record = EmptyRecord();
+            std::string error = ParseBody(line, record);
+            if (!error.empty())
+            {
+                errors.push_back("line " + std::to_string(line_number) + ": " + error);
+                continue;
+            }
+            if (IsBird(record.type))
+            {
+                bird_bodies++;
+            }
+            if (record.type == 'P')
+            {
+                asset.pig_count++;
+            }
+            asset.bodies.push_back(record);
+        }
+
+        if (bird_bodies != 1)
+        {
+            errors.push_back("level must have exactly one bird body, found " + std::to_string(bird_bodies));
+        }
+        if (asset.pig_count == 0)
+        {
+            errors.push_back("level has no pigs");
+        }
+
+        int bird_count = static_cast<int>(asset.birds.size());
+        for (int i = 1; i < 4; i++)
+        {
+            asset.star_thresholds[i - 1] = ((bird_count - asset.pig_count) * 1000 + asset.pig_count * 500) / i;
+        }
+        SortIntoChunks(asset);
+        return asset;
+    }
+
+    int32_t ChunkAt(char type, const b2Vec2 &position, float width)
+    {
+        if (IsBird(type) || type == 'G' || width > chunk_width)
+        {
+            return resident_chunk;
+        }
+        return static_cast<int32_t>(std::floor(position.x / chunk_width));
+    }
+
+    int32_t ChunkOf(const BodyRecord &record)
+    {
+        float width = 2 * record.radius;
+        for (int i = 0; i < record.vertex_count; i++)
+        {
+            width = std::max(width, 2 * std::abs(record.vertices[i].x));
+        }
+        return ChunkAt(record.type, record.position, width);
+    }
+
+    void SortIntoChunks(LevelAsset &asset)
+    {
+        std::vector<std::pair<int32_t, size_t>> keys;
+        keys.reserve(asset.bodies.size());
+        for (size_t i = 0; i < asset.bodies.size(); i++)
+        {
+            keys.push_back(std::make_pair(ChunkOf(asset.bodies[i]), i));
+        }
+        // Pairs compare by chunk first and then by the original index, so the sort is stable
+        std::sort(keys.begin(), keys.end());
+
+        std::vector<BodyRecord> sorted;
+        sorted.reserve(asset.bodies.size());
+        asset.chunks.clear();
+        for (const auto &key : keys)
+        {
+            if (asset.chunks.empty() || asset.chunks.back().chunk != key.first)
+            {
+                asset.chunks.push_back({key.first, static_cast<uint32_t>(sorted.size()), 0});
+            }
+            asset.chunks.back().count++;
+            sorted.push_back(asset.bodies[key.second]);
+        }
+        asset.bodies.swap(sorted);
+    }
+
+    std::list<std::tuple<std::string, int>> ParseHighScores(const std::string &line)
+    {
+        std::stringstream hs_ss(line);
+        std::list<std::tuple<std::string, int>> high_scores;
+        std::string high_score;
+        std::getline(hs_ss, high_score, ';');
+        while (hs_ss.good())
+        {
+            std::string name, score_str;
+            std::stringstream tmp(high_score);
+            std::getline(tmp, name, ':');
+            std::getline(tmp, score_str);
+
+            high_scores.push_back(std::make_tuple(name, std::atoi(score_str.c_str())));
+            std::getline(hs_ss, high_score, ';');
+        }
+        return high_scores;
+    }
+
+    uint64_t ContentHash(const std::string &text)
+    {
+        // 64-bit FNV-1a, skipping the second line and carriage returns
+        uint64_t hash = 14695981039346656037ULL;
+        int line = 1;
+        for (char c : text)
+        {
+            if (c == '\n')
+            {
+                line++;
+            }
+            if (line == 2 || c == '\r')
+            {
+                continue;
+            }
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    BodyRecord MakeRecord(char type, const b2Body *body)
+    {
+        BodyRecord record = EmptyRecord();
+        record.type = type;
+        record.body_type = body->GetType();
+        record.position = body->GetPosition();
+        record.angle = body->GetAngle();
+        record.angular_velocity = body->GetAngularVelocity();
+        record.linear_velocity = body->GetLinearVelocity();
+        record.angular_damping = body->GetAngularDamping();
+        record.linear_damping = body->GetLinearDamping();
+        record.gravity_scale = body->GetGravityScale();
+        record.awake = body->IsAwake();
+
+        const b2Fixture *fixture = body->GetFixtureList();
+        if (fixture == nullptr)
+        {
+            return record;
+        }
+        const b2Shape *shape = fixture->GetShape();
+        record.shape_type = shape->GetType();
+        record.radius = shape->m_radius;
+        if (record.shape_type == b2Shape::Type::e_polygon)
+        {
+            const b2PolygonShape *polygon = static_cast<const b2PolygonShape *>(shape);
+            record.center = polygon->m_centroid;
+            record.vertex_count = polygon->m_count;
+            for (int i = 0; i < polygon->m_count; i++)
+            {
+                record.vertices[i] = polygon->m_vertices[i];
+                record.normals[i] = polygon->m_normals[i];
+            }
+        }
+        else
+        {
+            record.center = static_cast<const b2CircleShape *>(shape)->m_p;
+        }
+        record.density = fixture->GetDensity();
+        record.friction = fixture->GetFriction();
+        record.restitution = fixture->GetRestitution();
+        return record;
+    }
+
+    void WriteText(std::ostream &output, const LevelAsset &asset)
+    {
+        const char s = ';'; // separator
+        // Enough digits that every float reads back exactly
+        std::streamsize precision = output.precision(std::numeric_limits<float>::max_digits10);
+        // Level name, high scores and the birds left on the first three lines
+        output << asset.name << std::endl;
+        for (const auto &high_score : asset.high_scores)
+        {
+            output << std::get<0>(high_score) << ":" << std::get<1>(high_score) << s;
+        }
+        output << std::endl
+               << asset.birds << std::endl;
+        if (asset.score != 0)
+        {
+            output << "score" << s << asset.score << s << std::endl;
+        }
+
+        // Then one body per line
+        for (const auto &record : asset.bodies)
+        {
+            output << record.type << s << record.position << s << record.angle << s
+                   << record.angular_velocity << s << record.linear_velocity << s
+                   << record.angular_damping << s << record.linear_damping << s
+                   << record.gravity_scale << s << record.body_type << s
+                   << record.awake << s << record.shape_type << s << record.center << s;
+            if (record.shape_type == b2Shape::Type::e_polygon)
+            {
+                // The format always has room for 8 vertices and normals
+                for (int i = 0; i < 8; i++)
+                {
+                    output << (i < record.vertex_count ? record.vertices[i] : b2Vec2(0, 0)) << s;
+                }
+                for (int i = 0; i < 8; i++)
+                {
+                    output << (i < record.vertex_count ? record.normals[i] : b2Vec2(0, 0)) << s;
+                }
+                output << record.vertex_count << s;
+            }
+            output << record.radius << s << record.density << s << record.friction << s << record.restitution << s;
+            if (record.damage > 0)
+            {
+                output << record.damage << s;
+            }
+            output << std::endl;
+        }
+        output.precision(precision);
+    }
+
+    void WriteBinary(std::ostream &output, const LevelAsset &asset)
+    {
+        uint32_t record_size = sizeof(BodyRecord);
+        uint32_t body_count = static_cast<uint32_t>(asset.bodies.size());
+        int32_t number = asset.number;
+        int32_t pig_count = asset.pig_count;
+
+        output.write(binary_magic, sizeof binary_magic);
+        output.write(reinterpret_cast<const char *>(&record_size), sizeof record_size);
+        output.write(reinterpret_cast<const char *>(&asset.source_hash), sizeof asset.source_hash);
+        WriteString(output, asset.name);
+        output.write(reinterpret_cast<const char *>(&number), sizeof number);
+        WriteString(output, asset.birds);
+        for (int i = 0; i < 3; i++)
+        {
+            int32_t threshold = asset.star_thresholds[i];
+            output.write(reinterpret_cast<const char *>(&threshold), sizeof threshold);
+        }
+        output.write(reinterpret_cast<const char *>(&pig_count), sizeof pig_count);
+        output.write(reinterpret_cast<const char *>(&body_count), sizeof body_count);
+        output.write(reinterpret_cast<const char *>(asset.bodies.data()), body_count * sizeof(BodyRecord));
+        uint32_t chunk_count = static_cast<uint32_t>(asset.chunks.size());
+        output.write(reinterpret_cast<const char *>(&chunk_count), sizeof chunk_count);
+        output.write(reinterpret_cast<const char *>(asset.chunks.data()), chunk_count * sizeof(ChunkRange));
+    }
+
+    bool ReadBinary(const char *data, size_t size, LevelAsset &asset)
+    {
+        BlockReader reader(data, size);
+        char magic[4];
+        uint32_t record_size, body_count;
+        int32_t number, pig_count, thresholds[3];
+
+        if (!reader.Read(magic, sizeof magic) || std::memcmp(magic, binary_magic, sizeof magic) != 0 ||
+            !reader.Read(&record_size, sizeof record_size) || record_size != sizeof(BodyRecord) ||
+            !reader.Read(&asset.source_hash, sizeof asset.source_hash) ||
+            !reader.ReadString(asset.name) ||
+            !reader.Read(&number, sizeof number) ||
+            !reader.ReadString(asset.birds) ||
+            !reader.Read(thresholds, sizeof thresholds) ||
+            !reader.Read(&pig_count, sizeof pig_count) ||
+            !reader.Read(&body_count, sizeof body_count))
+        {
+            return false;
+        }
+        asset.number = number;
+        asset.pig_count = pig_count;
+        for (int i = 0; i < 3; i++)
+        {
+            asset.star_thresholds[i] = thresholds[i];
+        }
+        asset.bodies.resize(body_count);
+        uint32_t chunk_count;
+        if (!reader.Read(asset.bodies.data(), body_count * sizeof(BodyRecord)) ||
+            !reader.Read(&chunk_count, sizeof chunk_count) || chunk_count > body_count)
+        {
+            return false;
+        }
+        asset.chunks.resize(chunk_count);
+        if (!reader.Read(asset.chunks.data(), chunk_count * sizeof(ChunkRange)))
+        {
+            return false;
+        }
+        // The table must cover the bodies exactly, in order
+        uint32_t next = 0;
+        for (const auto &range : asset.chunks)
+        {
+            if (range.first != next)
+            {
+                return false;
+            }
+            next += range.count;
+        }
+        return next == body_count;
+    }
+}
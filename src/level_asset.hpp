@@ -0,0 +1,108 @@
+#ifndef ANGRY_BIRDS_LEVEL_ASSET
+#define ANGRY_BIRDS_LEVEL_ASSET
+
+#include <box2d/box2d.h>
+#include <cstdint>
+#include <climits>
+#include <string>
+#include <list>
+#include <tuple>
+#include <vector>
+#include <iostream>
+
+// One body of a level with its fixture, plain data so it can be copied as is
+struct BodyRecord
+{
+    char type; // Object code: G, B, D, S, P or W
+    int32_t body_type;
+    b2Vec2 position;
+    float angle;
+    float angular_velocity;
+    b2Vec2 linear_velocity;
+    float angular_damping;
+    float linear_damping;
+    float gravity_scale;
+    int32_t awake;
+
+    int32_t shape_type;
+    b2Vec2 center; // Circle position or polygon centroid
+    float radius;
+    int32_t vertex_count;
+    b2Vec2 vertices[b2_maxPolygonVertices];
+    b2Vec2 normals[b2_maxPolygonVertices];
+
+    float density;
+    float friction;
+    float restitution;
+
+    float damage; // Destruction threshold lost so far, 0 for untouched objects
+};
+
+// Wide levels are split into vertical strips this many meters wide. A strip is
+// created in the world or unloaded back into records as a unit.
+const float chunk_width = 32.0f;
+
+// Birds, the ground and bodies wider than a chunk are never unloaded
+const int32_t resident_chunk = INT32_MIN;
+
+// Bodies [first, first + count) of a level belong to the chunk
+struct ChunkRange
+{
+    int32_t chunk;
+    uint32_t first;
+    uint32_t count;
+};
+
+// Everything needed to create a level, either parsed from a .ab file or
+// loaded from a binary asset compiled at build time
+struct LevelAsset
+{
+    std::string name;
+    int number = 0;
+    std::string birds; // Bird types in throwing order
+    std::vector<BodyRecord> bodies;
+    std::vector<ChunkRange> chunks; // Bodies are sorted by chunk, resident ones first
+    int star_thresholds[3] = {};
+    int pig_count = 0;
+    int score = 0; // Only set in saves of a level being played
+    uint64_t source_hash = 0;
+    // High scores are updated while playing so they always come from the .ab file
+    std::list<std::tuple<std::string, int>> high_scores;
+};
+
+namespace level_asset
+{
+    // Parses a level file. Every problem found is added to errors and the broken bodies are skipped,
+    // so the build can reject the file while the game can still load what is there.
+    LevelAsset Parse(std::istream &input, std::vector<std::string> &errors);
+
+    // Parses the "name:score;" high score line of a level file
+    std::list<std::tuple<std::string, int>> ParseHighScores(const std::string &line);
+
+    // Hash of the level file without the high score line, which changes while playing
+    uint64_t ContentHash(const std::string &text);
+
+    // Captures the current state of a body and its first fixture
+    BodyRecord MakeRecord(char type, const b2Body *body);
+
+    // Chunk of a body of the given type and width (meters) at position
+    int32_t ChunkAt(char type, const b2Vec2 &position, float width);
+
+    int32_t ChunkOf(const BodyRecord &record);
+
+    // Sorts the bodies by chunk keeping their order within a chunk and fills in asset.chunks
+    void SortIntoChunks(LevelAsset &asset);
+
+    // Writes the asset in the .ab text format read by Parse
+    void WriteText(std::ostream &output, const LevelAsset &asset);
+
+    void WriteBinary(std::ostream &output, const LevelAsset &asset);
+
+    // Reads a binary asset written by WriteBinary with the same build, high scores are left empty
+    bool ReadBinary(const char *data, size_t size, LevelAsset &asset);
+
+    // Finds a level compiled into the executable by its content hash
+    bool FindEmbedded(uint64_t source_hash, const char *&data, size_t &size);
+}
+
+#endif // ANGRY_BIRDS_LEVEL_ASSET
@@ -0,0 +1,187 @@
+#include "level_catalog.hpp"
+#include "level_asset.hpp"
+#include "converters.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <map>
+
+namespace
+{
+    const std::string levels_directory = "resources/levels";
+
+    std::string IndexPath()
+    {
+        return cache_directory + "/levels.txt";
+    }
+}
+
+LevelCatalog &LevelCatalog::Get()
+{
+    static LevelCatalog catalog;
+    return catalog;
+}
+
+LevelCatalog::LevelCatalog()
+{
+    Refresh();
+}
+
+void LevelCatalog::Refresh()
+{
+    std::vector<LevelInfo> previous;
+    if (levels_.empty())
+    {
+        LoadIndex(previous);
+    }
+    else
+    {
+        previous.swap(levels_);
+    }
+    std::map<std::string, const LevelInfo *> cached;
+    for (const auto &info : previous)
+    {
+        cached[info.path] = &info;
+    }
+
+    bool changed = false;
+    for (const auto &path : utils::ListFiles(levels_directory, "." + file_suffix))
+    {
+        long size = utils::FileSize(path);
+        long long modified = utils::FileModified(path);
+        auto it = cached.find(path);
+        if (it != cached.end() && it->second->file_size == size && it->second->modified == modified)
+        {
+            levels_.push_back(*it->second);
+        }
+        else
+        {
+            levels_.push_back(Read(path));
+            changed = true;
+        }
+    }
+    changed = changed || levels_.size() != previous.size();
+
+    std::stable_sort(levels_.begin(), levels_.end(), [](const LevelInfo &a, const LevelInfo &b)
+                     { return a.number < b.number; });
+    if (changed)
+    {
+        SaveIndex();
+    }
+}
+
+LevelInfo LevelCatalog::Read(const std::string &path)
+{
+    LevelInfo info;
+    info.path = path;
+    info.file_size = utils::FileSize(path);
+    info.modified = utils::FileModified(path);
+
+    std::ifstream file(path);
+    std::stringstream text;
+    text << file.rdbuf();
+    info.source_hash = level_asset::ContentHash(text.str());
+
+    std::vector<std::string> errors;
+    LevelAsset asset = level_asset::Parse(text, errors);
+    if (!errors.empty())
+    {
+        std::cerr << "Level catalog: " << path << ": " << errors.front() << std::endl;
+    }
+    info.name = asset.name;
+    info.number = asset.number;
+    info.body_count = static_cast<int>(asset.bodies.size());
+    info.pig_count = asset.pig_count;
+    std::copy(asset.star_thresholds, asset.star_thresholds + 3, info.star_thresholds);
+    for (const auto &high_score : asset.high_scores)
+    {
+        info.best_score = std::max(info.best_score, std::get<1>(high_score));
+    }
+    return info;
+}
+
+bool LevelCatalog::LoadIndex(std::vector<LevelInfo> &cached) const
+{
+    std::ifstream index(IndexPath());
+    std::string line;
+    while (std::getline(index, line))
+    {
+        // path<TAB>number size modified hash bodies pigs star1 star2 star3 best<TAB>name
+        std::stringstream fields(line);
+        LevelInfo info;
+        std::string numbers;
+        std::getline(fields, info.path, '\t');
+        std::getline(fields, numbers, '\t');
+        std::getline(fields, info.name);
+        std::stringstream values(numbers);
+        values >> info.number >> info.file_size >> info.modified >> std::hex >> info.source_hash >> std::dec >> info.body_count >> info.pig_count >> info.star_thresholds[0] >> info.star_thresholds[1] >> info.star_thresholds[2] >> info.best_score;
+        if (!values.fail())
+        {
+            cached.push_back(info);
+        }
+    }
+    return !cached.empty();
+}
+
+void LevelCatalog::SaveIndex() const
+{
+    utils::MakeDirectory(cache_directory);
+    std::ofstream index(IndexPath());
+    for (const auto &info : levels_)
+    {
+        index << info.path << '\t' << info.number << " " << info.file_size << " " << info.modified << " "
+              << std::hex << info.source_hash << std::dec << " " << info.body_count << " " << info.pig_count << " "
+              << info.star_thresholds[0] << " " << info.star_thresholds[1] << " " << info.star_thresholds[2] << " "
+              << info.best_score << '\t' << info.name << std::endl;
+    }
+}
+
+const LevelInfo *LevelCatalog::Find(int number) const
+{
+    for (const auto &info : levels_)
+    {
+        if (info.number == number)
+        {
+            return &info;
+        }
+    }
+    return nullptr;
+}
+
+const LevelInfo *LevelCatalog::FindPath(const std::string &path) const
+{
+    for (const auto &info : levels_)
+    {
+        if (info.path == path)
+        {
+            return &info;
+        }
+    }
+    return nullptr;
+}
+
+const LevelInfo *LevelCatalog::Next(int number) const
+{
+    for (const auto &info : levels_)
+    {
+        if (info.number > number)
+        {
+            return &info;
+        }
+    }
+    return nullptr;
+}
+
+void LevelCatalog::SetBestScore(const std::string &path, int best_score)
+{
+    for (auto &info : levels_)
+    {
+        if (info.path == path)
+        {
+            // The file was just written by the game, no need to read it again
+            info.best_score = best_score;
+            info.file_size = utils::FileSize(path);
+            info.modified = utils::FileModified(path);
+            SaveIndex();
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef ANGRY_BIRDS_LEVEL_CATALOG
+#define ANGRY_BIRDS_LEVEL_CATALOG
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// What the menus need to know about a level without loading it
+struct LevelInfo
+{
+    std::string path;
+    std::string name;
+    int number = 0;
+    int body_count = 0;
+    int pig_count = 0;
+    int star_thresholds[3] = {};
+    int best_score = 0;
+    uint64_t source_hash = 0;
+    // Used to notice edited files without reading them
+    long file_size = -1;
+    long long modified = -1;
+};
+
+// Index of every level in resources/levels ordered by level number. The index is
+// cached in cache/levels.txt and only the level files that have changed since
+// are read again, so opening a menu never touches the level files.
+class LevelCatalog
+{
+public:
+    static LevelCatalog &Get();
+
+    // Rescans the levels directory
+    void Refresh();
+
+    const std::vector<LevelInfo> &GetLevels() const { return levels_; }
+
+    // Returns nullptr if there is no such level
+    const LevelInfo *Find(int number) const;
+    const LevelInfo *FindPath(const std::string &path) const;
+
+    // The level after this one or nullptr if it is the last one
+    const LevelInfo *Next(int number) const;
+
+    // Keeps the best score up to date after the high scores of a level have been saved
+    void SetBestScore(const std::string &path, int best_score);
+
+private:
+    LevelCatalog();
+    bool LoadIndex(std::vector<LevelInfo> &cached) const;
+    void SaveIndex() const;
+    static LevelInfo Read(const std::string &path);
+
+    std::vector<LevelInfo> levels_;
+};
+
+#endif // ANGRY_BIRDS_LEVEL_CATALOG
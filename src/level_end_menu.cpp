@@ -1,4 +1,5 @@
 #include "level_end_menu.hpp"
+#include "level_catalog.hpp"
 
 LevelEndMenu::LevelEndMenu(int level_number)
 {
@@ -11,9 +12,8 @@ void LevelEndMenu::Draw(sf::RenderWindow &window)
     int loop_end = image_amount - 1;
     if (highscore_)
     {
-        textures_[2].loadFromFile("resources/images/highscore.png");
         elements_[2].setSize(sf::Vector2f(viewwidth, viewheight) / 6.0f);
-        elements_[2].setTexture(&textures_[2]);
+        TextureAtlas::Get().Apply(elements_[2], "highscore");
         elements_[2].setPosition(window.mapPixelToCoords(sf::Vector2i(5 * viewwidth / 12, viewheight / 5 * 2)));
         loop_end++;
     }
@@ -29,9 +29,8 @@ void LevelEndMenu::Draw(sf::RenderWindow &window)
 }
 void LevelEndMenu::SelectStars(int no_of_stars)
 {
-    textures_[1].loadFromFile("resources/images/" + std::to_string(no_of_stars) + "_stars.png");
     elements_[1].setSize(sf::Vector2f(viewwidth, viewheight) / 6.0f);
-    elements_[1].setTexture(&textures_[1]);
+    TextureAtlas::Get().Apply(elements_[1], std::to_string(no_of_stars) + "_stars");
 }
 
 void LevelEndMenu::SetLevel(int level_number)
@@ -46,14 +45,13 @@ void LevelEndMenu::SetLevel(int level_number)
     level_name_.setString("Level " + std::to_string(level_number_));
     level_name_.setCharacterSize(viewheight / 16);
 
-    if (level_number_ == 3)
+    elements_[0].setSize(sf::Vector2f(viewwidth, viewheight) / 2.0f);
+    if (LevelCatalog::Get().Next(level_number_) == nullptr)
     {
-        textures_[0].loadFromFile("resources/images/last_level_end.png");
+        TextureAtlas::Get().Apply(elements_[0], "last_level_end");
     }
     else
     {
-        textures_[0].loadFromFile("resources/images/level_end.png");
+        TextureAtlas::Get().Apply(elements_[0], "level_end");
     }
-    elements_[0].setSize(sf::Vector2f(viewwidth, viewheight) / 2.0f);
-    elements_[0].setTexture(&textures_[0]);
 }
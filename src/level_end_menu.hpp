@@ -3,6 +3,7 @@
 
 #include "menu.hpp"
 #include "converters.hpp"
+#include "atlas.hpp"
 #include <string>
 #include <iostream>
 class LevelEndMenu : public Menu
@@ -21,7 +22,6 @@ private:
     int level_number_;
     const static int image_amount = 3;
     sf::Text level_name_;
-    sf::Texture textures_[image_amount];
     sf::RectangleShape elements_[image_amount];
     bool highscore_;
 };
@@ -1,41 +1,181 @@
 #include "level_selector.hpp"
+#include "level_catalog.hpp"
+#include "memory_stats.hpp"
+#include <algorithm>
+#include <map>
+
+namespace
+{
+    long long TextureBytes(const sf::Texture &texture)
+    {
+        return 4LL * texture.getSize().x * texture.getSize().y;
+    }
+
+    sf::FloatRect SlotArea(int slot)
+    {
+        return sf::FloatRect(100.0f + slot * 500, 400, 400, 280);
+    }
+}
 
 LevelSelector::LevelSelector()
 {
-    std::string name_texts[level_amount_] = {"Level 1", "Level 2", "Level 3"};
-    std::string preview_filenames[level_amount_] = {"preview1.png", "preview2.png", "preview3.png"};
-    for (int i = 0; i < level_amount_; i++)
+    for (const auto &info : LevelCatalog::Get().GetLevels())
     {
-        level_names_[i].setFont(font_);
-        level_names_[i].setFillColor(sf::Color::White);
-        level_names_[i].setString(name_texts[i]);
-        level_names_[i].setCharacterSize(80);
-        level_names_[i].setPosition(100 + i * 500, 600);
+        Entry entry;
+        entry.path = info.path;
+        entry.name = info.name;
+        levels_.push_back(entry);
     }
+
+    level_name_.setFont(font_);
+    level_name_.setFillColor(sf::Color::White);
+    level_name_.setCharacterSize(80);
     back_button_.setFont(font_);
     back_button_.setFillColor(sf::Color::White);
     back_button_.setString("Back");
     back_button_.setCharacterSize(80);
     back_button_.setPosition(0, 100);
-    for (int i = 0; i < level_amount_; i++)
+    preview_image_.setSize(sf::Vector2f(viewwidth, viewheight) / 5.0f);
+}
+
+LevelSelector::~LevelSelector()
+{
+    for (const auto &level : levels_)
     {
-        preview_textures_[i].loadFromFile("resources/images/" + preview_filenames[i]);
-        preview_images_[i].setTexture(&preview_textures_[i]);
-        preview_images_[i].setSize(sf::Vector2f(viewwidth, viewheight) / 5.0f);
-        preview_images_[i].setPosition(100 + i * 500, 400);
+        memory_stats::Add(MemoryTag::Textures, -TextureBytes(level.texture));
     }
 }
 
-void LevelSelector::Draw(sf::RenderWindow &window)
+void LevelSelector::Scroll(int levels)
 {
-    window.draw(background_);
-    for (auto image : preview_images_)
+    int last_first = std::max(0, static_cast<int>(levels_.size()) - visible_levels_);
+    first_ = std::min(std::max(first_ + levels, 0), last_first);
+}
+
+void LevelSelector::Refresh()
+{
+    // Levels may have been added, removed or edited, thumbnails already loaded are kept
+    LevelCatalog::Get().Refresh();
+    std::map<std::string, Entry> previous;
+    for (auto &level : levels_)
+    {
+        previous[level.path] = std::move(level);
+    }
+    levels_.clear();
+    for (const auto &info : LevelCatalog::Get().GetLevels())
+    {
+        Entry entry;
+        auto it = previous.find(info.path);
+        if (it != previous.end())
+        {
+            entry = std::move(it->second);
+            previous.erase(it);
+        }
+        entry.path = info.path;
+        entry.name = info.name;
+        entry.requested = false;
+        levels_.push_back(std::move(entry));
+    }
+    for (const auto &removed : previous)
+    {
+        memory_stats::Add(MemoryTag::Textures, -TextureBytes(removed.second.texture));
+    }
+    Scroll(0);
+}
+
+std::string LevelSelector::LevelAt(sf::Vector2f position) const
+{
+    for (int slot = 0; slot < visible_levels_ && first_ + slot < static_cast<int>(levels_.size()); slot++)
+    {
+        if (SlotArea(slot).contains(position))
+        {
+            return levels_[first_ + slot].path;
+        }
+    }
+    return "";
+}
+
+void LevelSelector::UpdateThumbnails()
+{
+    for (auto &thumbnail : thumbnails_.Poll())
+    {
+        auto level = std::find_if(levels_.begin(), levels_.end(), [&thumbnail](const Entry &entry)
+                                  { return entry.path == thumbnail.path; });
+        if (level == levels_.end() || !level->requested)
+        {
+            continue; // Scrolled away before it was done
+        }
+        if (thumbnail.image.getSize().x > 0)
+        {
+            memory_stats::Add(MemoryTag::Textures, -TextureBytes(level->texture));
+            level->texture.loadFromImage(thumbnail.image);
+            memory_stats::Add(MemoryTag::Textures, TextureBytes(level->texture));
+            level->source_hash = thumbnail.source_hash;
+        }
+    }
+
+    // Keep the thumbnails on screen and one screen to both sides
+    int keep_from = first_ - visible_levels_;
+    int keep_to = first_ + 2 * visible_levels_;
+    for (int i = 0; i < static_cast<int>(levels_.size()); i++)
+    {
+        Entry &level = levels_[i];
+        if (i < keep_from || i >= keep_to)
+        {
+            if (level.requested)
+            {
+                memory_stats::Add(MemoryTag::Textures, -TextureBytes(level.texture));
+                level.texture = sf::Texture();
+                level.source_hash = 0;
+                level.requested = false;
+            }
+        }
+    }
+    auto request = [this](int i)
+    {
+        if (i >= 0 && i < static_cast<int>(levels_.size()) && !levels_[i].requested)
+        {
+            thumbnails_.Request(levels_[i].path, levels_[i].source_hash);
+            levels_[i].requested = true;
+        }
+    };
+    for (int i = keep_from; i < keep_to; i++)
+    {
+        if (i < first_ || i >= first_ + visible_levels_)
+        {
+            request(i);
+        }
+    }
+    for (int i = first_ + visible_levels_ - 1; i >= first_; i--)
     {
-        window.draw(image);
+        request(i);
     }
-    for (auto level_name : level_names_)
+}
+
+void LevelSelector::Draw(sf::RenderWindow &window)
+{
+    UpdateThumbnails();
+    window.draw(background_);
+    for (int slot = 0; slot < visible_levels_ && first_ + slot < static_cast<int>(levels_.size()); slot++)
     {
-        window.draw(level_name);
+        const Entry &level = levels_[first_ + slot];
+        sf::FloatRect area = SlotArea(slot);
+        if (level.source_hash != 0)
+        {
+            preview_image_.setTexture(&level.texture, true);
+            preview_image_.setFillColor(sf::Color::White);
+        }
+        else
+        {
+            // Placeholder until the thumbnail is ready
+            preview_image_.setTexture(nullptr);
+            preview_image_.setFillColor(sf::Color(255, 255, 255, 60));
+        }
+        preview_image_.setPosition(area.left, area.top);
+        window.draw(preview_image_);
+        level_name_.setString(level.name);
+        level_name_.setPosition(area.left, area.top + 200);
+        window.draw(level_name_);
     }
     window.draw(back_button_);
 }
@@ -2,19 +2,49 @@
 #define ANGRY_BIRDS_LEVEL_SELECTOR
 
 #include "menu.hpp"
+#include "thumbnails.hpp"
 #include <string>
+#include <vector>
 
+// Lists every level in the level catalog with a generated thumbnail. Only the
+// thumbnails of the levels on screen and next to it are requested and kept.
 class LevelSelector : public Menu
 {
 public:
     LevelSelector();
+    ~LevelSelector();
     void Draw(sf::RenderWindow &window);
 
+    // Moves the list by whole levels, positive to the right
+    void Scroll(int levels);
+
+    // Checks for new and edited levels, call when the selector is shown
+    void Refresh();
+
+    // Level file under the position or an empty string
+    std::string LevelAt(sf::Vector2f position) const;
+
+    // True while thumbnails are being generated
+    bool IsLoading() { return thumbnails_.IsBusy(); }
+
 private:
-    const static int level_amount_ = 3;
-    sf::Text level_names_[level_amount_];
-    sf::Texture preview_textures_[level_amount_];
-    sf::RectangleShape preview_images_[level_amount_];
+    struct Entry
+    {
+        std::string path;
+        std::string name;
+        uint64_t source_hash = 0; // Of the thumbnail in texture, 0 if there is none
+        bool requested = false;
+        sf::Texture texture;
+    };
+
+    void UpdateThumbnails();
+
+    const static int visible_levels_ = 3;
+    std::vector<Entry> levels_;
+    int first_ = 0; // Index of the leftmost level on screen
+    ThumbnailCache thumbnails_;
+    sf::Text level_name_;
+    sf::RectangleShape preview_image_;
     sf::Text back_button_;
 };
 
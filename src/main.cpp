@@ -1,13 +1,32 @@
-
-#include "game.hpp"
-
-int main()
-{
-    utils::PathPrefix();
-    Game game;
-    game.LoadIcon();
-    game.LoadLevel("resources/levels/level1.ab");
-    game.Start();
-
-    return 0;
-}
\ No newline at end of file
+#include "game.hpp"
+
+int main(int argc, char *argv[])
+{
+    // --pacing vsync|precise|uncapped, uncapped runs as fast as possible for throughput tests
+    // --physics box2d|islands, islands steps independent parts of the level on several cores
+    PacingMode pacing = PacingMode::Precise;
+    PhysicsBackend physics = PhysicsBackend::Box2D;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::string(argv[i]) == "--pacing" && !FramePacer::ParseMode(argv[i + 1], pacing))
+        {
+            std::cerr << "Unknown pacing mode: " << argv[i + 1] << std::endl;
+        }
+        if (std::string(argv[i]) == "--physics" && !PhysicsWorld::ParseBackend(argv[i + 1], physics))
+        {
+            std::cerr << "Unknown physics backend: " << argv[i + 1] << std::endl;
+        }
+    }
+
+    utils::PathPrefix();
+    Game game(pacing, physics);
+    game.LoadIcon();
+    const std::vector<LevelInfo> &levels = LevelCatalog::Get().GetLevels();
+    if (!levels.empty())
+    {
+        game.LoadLevel(levels.front().path);
+    }
+    game.Start();
+
+    return 0;
+}
@@ -2,7 +2,7 @@
 
 MainMenu::MainMenu() : Menu()
 {
-    std::string button_texts[button_amount_] = {"Play", "High Scores", "Exit", "Player Name:", nickname_};
+    std::string button_texts[button_amount_] = {"Play", "High Scores", "Exit", "Player Name:", nickname_, "Continue"};
     for (int i = 0; i < button_amount_; ++i)
     {
         menu_items_[i].setFont(font_);
@@ -20,6 +20,9 @@ MainMenu::MainMenu() : Menu()
     menu_items_[4].setPosition(1020, 535);
     menu_items_[3].setFillColor(sf::Color::Black);
     menu_items_[4].setFillColor(sf::Color::Black);
+    menu_items_[5].setFillColor(sf::Color::White);
+    menu_items_[5].setCharacterSize(80);
+    menu_items_[5].setPosition(1000, 100);
     nickname_input_.setFillColor(sf::Color::White);
     nickname_input_.setSize(sf::Vector2f(viewwidth / 5.0f, viewheight / 10.0f));
     nickname_input_.setPosition(1006, 500);
@@ -29,8 +32,11 @@ void MainMenu::Draw(sf::RenderWindow &window)
 {
     window.draw(background_);
     window.draw(nickname_input_);
-    for (auto menu_item : menu_items_)
+    for (int i = 0; i < button_amount_; ++i)
     {
-        window.draw(menu_item);
+        if (i != 5 || show_continue_)
+        {
+            window.draw(menu_items_[i]);
+        }
     }
 }
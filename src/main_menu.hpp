@@ -32,12 +32,16 @@ public:
 
         menu_items_[4].setString(nickname_);
     }
+    // Continue is only shown while there is an autosave to resume
+    void ShowContinue(bool show) { show_continue_ = show; }
+    bool IsContinueShown() const { return show_continue_; }
 
 private:
-    const static int button_amount_ = 5;
+    const static int button_amount_ = 6;
     sf::Text menu_items_[button_amount_];
     sf::RectangleShape nickname_input_;
     std::string nickname_ = "Player 1";
+    bool show_continue_ = false;
 };
 
 #endif
@@ -0,0 +1,126 @@
+#include "memory_stats.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+    const int tag_count = static_cast<int>(MemoryTag::Count);
+    const char *tag_names[tag_count] = {"objects", "box2d", "textures", "images", "audio", "rewind"};
+
+    std::atomic<long long> current_bytes[tag_count];
+    std::atomic<long long> peak_bytes[tag_count];
+
+    // Box2D frees without a size, so it is stored in front of each block.
+    // The header keeps the block aligned for anything Box2D puts in it.
+    union AllocationHeader
+    {
+        size_t size;
+        std::max_align_t alignment;
+    };
+
+    std::string Kilobytes(long long bytes)
+    {
+        std::stringstream text;
+        text << std::fixed << std::setprecision(1) << bytes / 1024.0 << " KB";
+        return text.str();
+    }
+}
+
+namespace memory_stats
+{
+    void Add(MemoryTag tag, long long bytes)
+    {
+        int i = static_cast<int>(tag);
+        long long now = current_bytes[i] += bytes;
+        long long peak = peak_bytes[i];
+        while (now > peak && !peak_bytes[i].compare_exchange_weak(peak, now))
+        {
+        }
+    }
+
+    long long Current(MemoryTag tag)
+    {
+        return current_bytes[static_cast<int>(tag)];
+    }
+
+    long long Peak(MemoryTag tag)
+    {
+        return peak_bytes[static_cast<int>(tag)];
+    }
+
+    const char *TagName(MemoryTag tag)
+    {
+        return tag_names[static_cast<int>(tag)];
+    }
+
+    Snapshot Take()
+    {
+        Snapshot snapshot;
+        for (int i = 0; i < tag_count; i++)
+        {
+            snapshot.bytes[i] = current_bytes[i];
+        }
+        return snapshot;
+    }
+
+    std::string Summary()
+    {
+        std::stringstream text;
+        for (int i = 0; i < tag_count; i++)
+        {
+            text << tag_names[i] << ": " << Kilobytes(current_bytes[i]) << " (peak " << Kilobytes(peak_bytes[i]) << ")" << std::endl;
+        }
+        return text.str();
+    }
+
+    void PrintDelta(std::ostream &output, const std::string &label, const Snapshot &before)
+    {
+        output << "Memory after " << label << ":";
+        for (int i = 0; i < tag_count; i++)
+        {
+            long long delta = current_bytes[i] - before.bytes[i];
+            if (delta != 0)
+            {
+                output << " " << tag_names[i] << " " << (delta > 0 ? "+" : "-") << Kilobytes(std::llabs(delta))
+                       << " (" << Kilobytes(current_bytes[i]) << ")";
+            }
+        }
+        output << std::endl;
+    }
+
+    void WriteJson(std::ostream &output)
+    {
+        output << "{" << std::endl;
+        for (int i = 0; i < tag_count; i++)
+        {
+            output << "  \"" << tag_names[i] << "\": {\"current\": " << current_bytes[i] << ", \"peak\": " << peak_bytes[i] << "}"
+                   << (i + 1 < tag_count ? "," : "") << std::endl;
+        }
+        output << "}" << std::endl;
+    }
+
+    void *Box2DAlloc(int size)
+    {
+        AllocationHeader *header = static_cast<AllocationHeader *>(std::malloc(sizeof(AllocationHeader) + size));
+        if (header == nullptr)
+        {
+            return nullptr;
+        }
+        header->size = size;
+        Add(MemoryTag::Box2D, size);
+        return header + 1;
+    }
+
+    void Box2DFree(void *memory)
+    {
+        if (memory == nullptr)
+        {
+            return;
+        }
+        AllocationHeader *header = static_cast<AllocationHeader *>(memory) - 1;
+        Add(MemoryTag::Box2D, -static_cast<long long>(header->size));
+        std::free(header);
+    }
+}
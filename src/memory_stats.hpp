@@ -0,0 +1,51 @@
+#ifndef ANGRY_BIRDS_MEMORY_STATS
+#define ANGRY_BIRDS_MEMORY_STATS
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+// What the counted memory is used for
+enum class MemoryTag
+{
+    Objects,  // Game objects
+    Box2D,    // Everything Box2D allocates through b2Alloc
+    Textures, // Pixels uploaded to the GPU
+    Images,   // Decoded pixels kept in main memory
+    Audio,    // Decoded sound effects, music is streamed
+    Rewind,   // Rewind snapshots
+    Count
+};
+
+// Current and peak bytes per tag. The counters are atomic so they can be
+// updated from any thread.
+namespace memory_stats
+{
+    // Adds bytes to the tag, negative to release them
+    void Add(MemoryTag tag, long long bytes);
+
+    long long Current(MemoryTag tag);
+    long long Peak(MemoryTag tag);
+    const char *TagName(MemoryTag tag);
+
+    // Current values of every tag, to compute deltas between two points in time
+    struct Snapshot
+    {
+        long long bytes[static_cast<int>(MemoryTag::Count)];
+    };
+    Snapshot Take();
+
+    // One line per tag with current and peak
+    std::string Summary();
+
+    // Prints the tags that changed since before
+    void PrintDelta(std::ostream &output, const std::string &label, const Snapshot &before);
+
+    void WriteJson(std::ostream &output);
+
+    // Box2D allocation hooks, see b2_user_settings.h
+    void *Box2DAlloc(int size);
+    void Box2DFree(void *memory);
+}
+
+#endif // ANGRY_BIRDS_MEMORY_STATS
@@ -1,12 +1,21 @@
 #include "menu.hpp"
 
-Menu::Menu()
+namespace
+{
+    const std::string menu_background = "resources/images/menu.png";
+}
+
+void Menu::Preload()
+{
+    AssetLoader::Get().Queue(font_file, AssetKind::Font);
+    AssetLoader::Get().Queue(menu_background, AssetKind::Texture);
+}
+
+Menu::Menu() : font_(AssetLoader::Get().GetFont(font_file))
 {
-    font_.loadFromFile("resources/fonts/Raleway-Medium.ttf");
     open_ = true;
-    background_image_.loadFromFile("resources/images/menu.png");
     background_.setSize(sf::Vector2f(viewwidth, viewheight));
-    background_.setTexture(&background_image_);
+    background_.setTexture(&AssetLoader::Get().GetTexture(menu_background));
     background_.setPosition(0, 0);
 };
 
@@ -3,6 +3,7 @@
 
 #include <SFML/Graphics.hpp>
 #include "converters.hpp"
+#include "asset_loader.hpp"
 
 class Menu
 {
@@ -14,11 +15,13 @@ public:
     void Close();
     void Open();
 
+    // Starts loading the font and background shared by all menus
+    static void Preload();
+
 protected:
     bool open_;
-    sf::Font font_;
+    const sf::Font &font_;
     sf::RectangleShape background_;
-    sf::Texture background_image_;
 };
 
 #endif
\ No newline at end of file
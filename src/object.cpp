@@ -1,58 +1,34 @@
 #include "object.hpp"
 #include "utils.hpp"
+#include "memory_stats.hpp"
 
-Object::Object(std::string texture_file, b2Body *body) : body_(body)
+Object::Object(b2Body *body, TextureId texture, SoundId sound, MaterialId material, float b2_w, float b2_h)
+    : width_(b2_w), height_(b2_h), texture_(texture), sound_(sound), material_(material), body_(body)
 {
-    texture_.loadFromFile(texture_file);
-    sprite_.setTexture(texture_);
+    destruction_threshold_ = GetMaterial().destruction_threshold;
 }
 
-Object::Object(b2Body *body) : body_(body){};
+void *Object::operator new(std::size_t size)
+{
+    memory_stats::Add(MemoryTag::Objects, size);
+    return ::operator new(size);
+}
 
-void Object::SaveState(std::ofstream &file)
+void Object::operator delete(void *memory, std::size_t size)
 {
-    const char s = ';'; // separator
-    file << GetType() << s;
-    // first save all box2d attributes
-    file << body_->GetPosition() << s << body_->GetAngle() << s
-         << body_->GetAngularVelocity() << s << body_->GetLinearVelocity() << s
-         << body_->GetAngularDamping() << s << body_->GetLinearDamping() << s
-         << body_->GetGravityScale() << s << body_->GetType() << s
-         << body_->IsAwake() << s;
+    memory_stats::Add(MemoryTag::Objects, -static_cast<long long>(size));
+    ::operator delete(memory);
+}
 
-    b2Fixture *fixture = body_->GetFixtureList();
-    while (fixture != nullptr)
-    {
-        b2Shape::Type shape_type = fixture->GetType();
-        b2Shape *shape_data = fixture->GetShape();
-        file << shape_type << s;
-        switch (shape_type)
-        {
-        case b2Shape::Type::e_circle:
-            b2CircleShape *circle;
-            circle = static_cast<b2CircleShape *>(shape_data);
-            file << circle->m_p << s << circle->m_radius << s;
-            break;
-        case b2Shape::Type::e_polygon:
-            b2PolygonShape *polygon;
-            polygon = static_cast<b2PolygonShape *>(shape_data);
-            file << polygon->m_centroid << s;
-            for (auto vertex : polygon->m_vertices)
-            {
-                file << vertex << s;
-            }
-            for (auto normal : polygon->m_normals)
-            {
-                file << normal << s;
-            }
-            file << polygon->m_count << s << polygon->m_radius << s;
-            break;
-        default:
-            continue;
-        }
-        file << fixture->GetDensity() << s << fixture->GetFriction() << s << fixture->GetRestitution() << s;
-        fixture = fixture->GetNext();
-    }
+sf::Sprite Object::GetSprite() const
+{
+    sf::Sprite sprite = Resources::Get().GetSprite(texture_);
+    float w = static_cast<float>(sprite.getTextureRect().width);
+    float h = static_cast<float>(sprite.getTextureRect().height);
+
+    sprite.setScale(width_ * 2.0f * scale / w, height_ * 2.0f * scale / h);
+    sprite.setOrigin(w / 2.f, h / 2.f);
+    return sprite;
 }
 
 int Object::TryToDestroy(float power)
@@ -62,17 +38,20 @@ int Object::TryToDestroy(float power)
         return 0;
     }
     destruction_threshold_ = destruction_threshold_ - power;
-    if (destructable_ && 0.f > destruction_threshold_)
+    if (IsDestructable() && 0.f > destruction_threshold_)
     {
         destroyed = true;
-        return destruction_points_;
+        return GetMaterial().destruction_points;
     }
     return 0;
 }
+int Object::Destroy()
+{
+    destroyed = true;
+    return IsDestructable() ? GetMaterial().destruction_points : 0;
+}
+
 void Object::MakeSound()
 {
-    punch_sound_buffer_.loadFromFile("resources/sounds/punch.wav");
-    punch_sound_.setBuffer(punch_sound_buffer_);
-    punch_sound_.setVolume(100);
-    punch_sound_.play();
+    Resources::Get().PlaySound(sound_, 100);
 }
\ No newline at end of file
@@ -2,55 +2,74 @@
 #define ANGRY_BIRDS_OBJECT
 
 #include <SFML/Graphics.hpp>
-#include <SFML/Audio.hpp>
 #include <box2d/box2d.h>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include "converters.hpp"
+#include "resources.hpp"
 
 class Object
 {
 public:
-    Object(std::string texture_file, b2Body *body);
-
-    Object(b2Body *body);
+    // b2_w and b2_h are the half width and half height of the body in meters
+    Object(b2Body *body, TextureId texture, SoundId sound, MaterialId material, float b2_w, float b2_h);
 
     virtual ~Object() {}
 
+    // Counted in the memory report under MemoryTag::Objects
+    static void *operator new(std::size_t size);
+    static void operator delete(void *memory, std::size_t size);
+
     b2Body *GetBody() { return body_; }
 
-    sf::Sprite &GetSprite() { return sprite_; }
+    // For when the physics world recreates the body, see PhysicsWorld::GetMovedBodies
+    void SetBody(b2Body *body) { body_ = body; }
+
+    // Half width and half height in meters
+    b2Vec2 GetHalfSize() const { return b2Vec2(width_, height_); }
 
-    bool IsDestructable() { return destructable_; }
+    // Sprite scaled to the size of the body, objects only store which texture they use
+    virtual sf::Sprite GetSprite() const;
+
+    bool IsDestructable() const { return GetMaterial().destructable; }
 
     virtual void UsePower(){};
 
     float GetDThreshold() { return destruction_threshold_; }
 
+    void SetDThreshold(float threshold) { destruction_threshold_ = threshold; }
+
+    // Index of the body in the level it was created from, stays the same when the body is recreated
+    uint32_t GetId() const { return id_; }
+    void SetId(uint32_t id) { id_ = id; }
+
     bool IsDestroyed() const { return destroyed; }
 
     virtual int TryToDestroy(float power);
 
-    void SaveState(std::ofstream &file);
+    // Destroys the object regardless of its health, returns the points it is worth
+    int Destroy();
 
     // Get type of the object (for serialization purposes)
     virtual char GetType() = 0;
 
-    void MakeSound();
+    virtual void MakeSound();
 
 protected:
-    sf::Sprite sprite_;
-    sf::Texture texture_;
-    bool destructable_ = false;
-    float destruction_threshold_ = 0.f;
-    int destruction_points_ = 20;
-    sf::SoundBuffer punch_sound_buffer_;
-    sf::Sound punch_sound_;
+    const Material &GetMaterial() const { return Resources::Get().GetMaterial(material_); }
+
+    float width_;
+    float height_;
+    TextureId texture_;
+    SoundId sound_;
+    MaterialId material_;
 
 private:
-    b2Body *body_;
     bool destroyed = false;
+    float destruction_threshold_;
+    uint32_t id_ = 0;
+    b2Body *body_;
 };
 
-#endif // ANGRY_BIRDS_OBJECT
\ No newline at end of file
+#endif // ANGRY_BIRDS_OBJECT
@@ -0,0 +1,106 @@
+#include "particles.hpp"
+#include "converters.hpp"
+#include <algorithm>
+
+namespace
+{
+    const float particle_lifetime = 1.2f;       // Seconds, each particle gets 50-100% of this
+    const float particle_speed = 400.0f;        // Pixels per second at most
+    const float particle_gravity = -gravity.y * scale; // Pixels per second squared, downwards on screen
+}
+
+ParticleSystem::ParticleSystem(size_t capacity)
+    : capacity_(capacity), x_(capacity), y_(capacity), vx_(capacity), vy_(capacity),
+      life_(capacity), size_px_(capacity), color_(capacity), vertices_(sf::Quads, capacity * 4)
+{
+}
+
+void ParticleSystem::Emit(const sf::FloatRect &area, sf::Color color, int count)
+{
+    // Past half capacity every burst is thinned out in proportion to the space left
+    size_t free = capacity_ - size_;
+    if (size_ > capacity_ / 2)
+    {
+        count = static_cast<int>(count * free / (capacity_ - capacity_ / 2));
+    }
+    count = std::min(count, static_cast<int>(free));
+
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int n = 0; n < count; n++)
+    {
+        size_t i = size_++;
+        x_[i] = area.left + unit(random_) * area.width;
+        y_[i] = area.top + unit(random_) * area.height;
+        float angle = unit(random_) * 2 * static_cast<float>(M_PI);
+        float speed = unit(random_) * particle_speed;
+        vx_[i] = std::cos(angle) * speed;
+        vy_[i] = std::sin(angle) * speed - particle_speed / 2; // Bias upwards
+        life_[i] = particle_lifetime * (0.5f + unit(random_) / 2);
+        size_px_[i] = 4.0f + unit(random_) * 8.0f;
+        color_[i] = color;
+    }
+}
+
+void ParticleSystem::Update(float dt)
+{
+    // Branch free loops over plain float arrays, simple enough for the compiler to vectorize
+    float *x = x_.data(), *y = y_.data(), *vx = vx_.data(), *vy = vy_.data(), *life = life_.data();
+    size_t n = size_;
+    for (size_t i = 0; i < n; i++)
+    {
+        vy[i] += particle_gravity * dt;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+        life[i] -= dt;
+    }
+
+    for (size_t i = 0; i < size_;)
+    {
+        if (life_[i] <= 0)
+        {
+            Remove(i);
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
+
+void ParticleSystem::Remove(size_t i)
+{
+    // Order doesn't matter so the last particle takes the place of the removed one
+    size_t last = --size_;
+    x_[i] = x_[last];
+    y_[i] = y_[last];
+    vx_[i] = vx_[last];
+    vy_[i] = vy_[last];
+    life_[i] = life_[last];
+    size_px_[i] = size_px_[last];
+    color_[i] = color_[last];
+}
+
+void ParticleSystem::Draw(sf::RenderTarget &target)
+{
+    if (size_ == 0)
+    {
+        return;
+    }
+    vertices_.resize(size_ * 4);
+    for (size_t i = 0; i < size_; i++)
+    {
+        float half = size_px_[i] / 2;
+        sf::Color color = color_[i];
+        // Fade out during the last third of a second
+        color.a = static_cast<sf::Uint8>(color.a * std::min(1.0f, life_[i] * 3));
+        sf::Vertex *quad = &vertices_[i * 4];
+        quad[0] = sf::Vertex(sf::Vector2f(x_[i] - half, y_[i] - half), color);
+        quad[1] = sf::Vertex(sf::Vector2f(x_[i] + half, y_[i] - half), color);
+        quad[2] = sf::Vertex(sf::Vector2f(x_[i] + half, y_[i] + half), color);
+        quad[3] = sf::Vertex(sf::Vector2f(x_[i] - half, y_[i] + half), color);
+    }
+    target.draw(vertices_);
+}
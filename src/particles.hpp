@@ -0,0 +1,45 @@
+#ifndef ANGRY_BIRDS_PARTICLES
+#define ANGRY_BIRDS_PARTICLES
+
+#include <SFML/Graphics.hpp>
+#include <random>
+#include <vector>
+
+// Debris flying off destroyed objects. Particles live in a fixed size pool stored
+// as one array per attribute, so updating them is a few tight loops over floats
+// and drawing them is a single vertex array. The pool never grows: when it fills
+// up emitters get fewer particles and finally none at all.
+class ParticleSystem
+{
+public:
+    explicit ParticleSystem(size_t capacity = 1024);
+
+    // Bursts debris of the given color out of a rectangle in SFML coordinates
+    void Emit(const sf::FloatRect &area, sf::Color color, int count);
+
+    // Moves particles forward by dt seconds and drops the expired ones
+    void Update(float dt);
+
+    void Draw(sf::RenderTarget &target);
+
+    void Clear() { size_ = 0; }
+
+    size_t GetCount() const { return size_; }
+
+    size_t GetCapacity() const { return capacity_; }
+
+private:
+    void Remove(size_t i);
+
+    size_t capacity_;
+    size_t size_ = 0;
+    std::vector<float> x_, y_;   // Position in pixels
+    std::vector<float> vx_, vy_; // Velocity in pixels per second
+    std::vector<float> life_;    // Seconds left
+    std::vector<float> size_px_; // Side of the square in pixels
+    std::vector<sf::Color> color_;
+    std::minstd_rand random_;
+    sf::VertexArray vertices_; // Reused between frames to avoid reallocating
+};
+
+#endif // ANGRY_BIRDS_PARTICLES
@@ -0,0 +1,71 @@
+#include "physics_world.hpp"
+#include "island_world.hpp"
+
+namespace
+{
+    const char *backend_names[] = {"box2d", "islands"};
+
+    class QueryCallback : public b2QueryCallback
+    {
+    public:
+        explicit QueryCallback(const std::function<bool(b2Fixture *)> &callback) : callback_(callback) {}
+        bool ReportFixture(b2Fixture *fixture) override { return callback_(fixture); }
+
+    private:
+        const std::function<bool(b2Fixture *)> &callback_;
+    };
+}
+
+std::unique_ptr<PhysicsWorld> PhysicsWorld::Create(PhysicsBackend backend, const b2Vec2 &gravity)
+{
+    if (backend == PhysicsBackend::Islands)
+    {
+        return std::unique_ptr<PhysicsWorld>(new IslandWorld(gravity));
+    }
+    return std::unique_ptr<PhysicsWorld>(new Box2DWorld(gravity));
+}
+
+const char *PhysicsWorld::BackendName(PhysicsBackend backend)
+{
+    return backend_names[static_cast<int>(backend)];
+}
+
+bool PhysicsWorld::ParseBackend(const std::string &name, PhysicsBackend &backend)
+{
+    for (int i = 0; i < 2; i++)
+    {
+        if (name == backend_names[i])
+        {
+            backend = static_cast<PhysicsBackend>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void Box2DWorld::Step(float time_step, int velocity_iterations, int position_iterations)
+{
+    world_.Step(time_step, velocity_iterations, position_iterations);
+}
+
+void Box2DWorld::ForEachBody(const std::function<void(b2Body *)> &callback)
+{
+    for (b2Body *body = world_.GetBodyList(); body; body = body->GetNext())
+    {
+        callback(body);
+    }
+}
+
+void Box2DWorld::ForEachContact(const std::function<void(b2Contact *)> &callback)
+{
+    for (b2Contact *contact = world_.GetContactList(); contact; contact = contact->GetNext())
+    {
+        callback(contact);
+    }
+}
+
+void Box2DWorld::QueryAABB(const b2AABB &aabb, const std::function<bool(b2Fixture *)> &callback)
+{
+    QueryCallback query(callback);
+    world_.QueryAABB(&query, aabb);
+}
@@ -0,0 +1,89 @@
+#ifndef ANGRY_BIRDS_PHYSICS_WORLD
+#define ANGRY_BIRDS_PHYSICS_WORLD
+
+#include <box2d/box2d.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class PhysicsBackend
+{
+    Box2D,  // One b2World stepped on the calling thread
+    Islands // Independent groups of bodies in their own b2Worlds, stepped in parallel
+};
+
+// A body the backend had to recreate, see PhysicsWorld::GetMovedBodies
+struct BodyMove
+{
+    b2Body *from; // Destroyed, only good for comparing
+    b2Body *to;
+};
+
+// The simulation a level runs in. Bodies, fixtures, shapes and contacts are plain
+// Box2D types whatever the backend, only creating and destroying bodies, stepping
+// and looking through the world go through here.
+class PhysicsWorld
+{
+public:
+    virtual ~PhysicsWorld() {}
+
+    virtual b2Body *CreateBody(const b2BodyDef &def) = 0;
+
+    // Destroys the body and its fixtures
+    virtual void DestroyBody(b2Body *body) = 0;
+
+    virtual void Step(float time_step, int velocity_iterations, int position_iterations) = 0;
+
+    // Bodies the last Step recreated, with their fixtures, velocities and user data
+    // copied over. Whoever keeps a pointer to a moved body has to switch to the new one.
+    // Every body is listed at most once, even if it was moved more than once.
+    virtual const std::vector<BodyMove> &GetMovedBodies() const = 0;
+
+    virtual int GetBodyCount() const = 0;
+
+    virtual int GetContactCount() const = 0;
+
+    virtual void ForEachBody(const std::function<void(b2Body *)> &callback) = 0;
+
+    // Every contact whose fixtures' bounding boxes overlap, touching or not, like b2World::GetContactList
+    virtual void ForEachContact(const std::function<void(b2Contact *)> &callback) = 0;
+
+    // Fixtures whose bounding box overlaps aabb, return false from callback to stop
+    virtual void QueryAABB(const b2AABB &aabb, const std::function<bool(b2Fixture *)> &callback) = 0;
+
+    virtual PhysicsBackend GetBackend() const = 0;
+
+    static std::unique_ptr<PhysicsWorld> Create(PhysicsBackend backend, const b2Vec2 &gravity);
+
+    static const char *BackendName(PhysicsBackend backend);
+
+    // Parses box2d or islands, returns false for anything else
+    static bool ParseBackend(const std::string &name, PhysicsBackend &backend);
+};
+
+// The single b2World the game has always used
+class Box2DWorld : public PhysicsWorld
+{
+public:
+    explicit Box2DWorld(const b2Vec2 &gravity) : world_(gravity) {}
+
+    b2Body *CreateBody(const b2BodyDef &def) override { return world_.CreateBody(&def); }
+    void DestroyBody(b2Body *body) override { world_.DestroyBody(body); }
+    void Step(float time_step, int velocity_iterations, int position_iterations) override;
+    const std::vector<BodyMove> &GetMovedBodies() const override { return moved_; }
+    int GetBodyCount() const override { return world_.GetBodyCount(); }
+    int GetContactCount() const override { return world_.GetContactCount(); }
+    void ForEachBody(const std::function<void(b2Body *)> &callback) override;
+    void ForEachContact(const std::function<void(b2Contact *)> &callback) override;
+    void QueryAABB(const b2AABB &aabb, const std::function<bool(b2Fixture *)> &callback) override;
+    PhysicsBackend GetBackend() const override { return PhysicsBackend::Box2D; }
+
+    b2World &GetB2World() { return world_; }
+
+private:
+    b2World world_;
+    std::vector<BodyMove> moved_; // Always empty, bodies stay where they are created
+};
+
+#endif // ANGRY_BIRDS_PHYSICS_WORLD
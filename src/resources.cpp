@@ -0,0 +1,110 @@
+#include "resources.hpp"
+#include "asset_loader.hpp"
+
+namespace
+{
+    // Atlas image of each texture, the ground is tiled so it has its own texture
+    const std::string texture_names[] = {"bird", "bird2", "bird3", "pig", "box", ""};
+
+    const std::string ground_file = "resources/images/ground.png";
+
+    const std::string sound_files[] = {
+        "resources/sounds/punch.wav",
+        "resources/sounds/pig.wav",
+        "resources/sounds/bird.wav"};
+
+    const Material materials[] = {
+        {false, 0.f, 20},  // Ground
+        {true, 600.f, 20}, // Wall
+        {true, 100.f, 500}, // Pig
+        {false, 0.f, 20}}; // Bird
+}
+
+Resources &Resources::Get()
+{
+    static Resources resources;
+    return resources;
+}
+
+Resources::Resources() {}
+
+void Resources::Preload()
+{
+    AssetLoader::Get().Queue(ground_file, AssetKind::Texture);
+    for (const auto &file : sound_files)
+    {
+        AssetLoader::Get().Queue(file, AssetKind::Sound);
+    }
+}
+
+sf::Sprite Resources::GetSprite(TextureId id)
+{
+    sf::Sprite sprite;
+    if (id == TextureId::Ground)
+    {
+        if (ground_texture_ == nullptr)
+        {
+            ground_texture_ = &AssetLoader::Get().GetTexture(ground_file);
+            ground_texture_->setRepeated(true);
+        }
+        sprite.setTexture(*ground_texture_);
+    }
+    else
+    {
+        // Called for every object drawn, so the names are only looked up the first time
+        const TextureAtlas &atlas = TextureAtlas::Get();
+        if (!regions_resolved_)
+        {
+            for (int i = 0; i < static_cast<int>(TextureId::Count); i++)
+            {
+                if (!texture_names[i].empty())
+                {
+                    regions_[i] = atlas.GetRegion(texture_names[i]);
+                }
+            }
+            regions_resolved_ = true;
+        }
+        atlas.Apply(sprite, regions_[static_cast<int>(id)]);
+    }
+    return sprite;
+}
+
+const Material &Resources::GetMaterial(MaterialId id) const
+{
+    return materials[static_cast<int>(id)];
+}
+
+void Resources::PlaySound(SoundId id, float volume)
+{
+    if (muted_)
+    {
+        return;
+    }
+    if (!voices_)
+    {
+        voices_.reset(new sf::Sound[voice_count_]);
+    }
+    int i = static_cast<int>(id);
+    if (sound_buffers_[i] == nullptr)
+    {
+        sound_buffers_[i] = &AssetLoader::Get().GetSoundBuffer(sound_files[i]);
+    }
+
+    // Prefer a free voice, otherwise cut the one that was started longest ago
+    int voice = next_voice_;
+    for (int v = 0; v < voice_count_; v++)
+    {
+        int candidate = (next_voice_ + v) % voice_count_;
+        if (voices_[candidate].getStatus() != sf::Sound::Playing)
+        {
+            voice = candidate;
+            break;
+        }
+    }
+    next_voice_ = (voice + 1) % voice_count_;
+
+    voices_[voice].stop();
+    voices_[voice].setBuffer(*sound_buffers_[i]);
+    voices_[voice].setVolume(volume);
+    voices_[voice].play();
+}
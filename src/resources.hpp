@@ -0,0 +1,80 @@
+#ifndef ANGRY_BIRDS_RESOURCES
+#define ANGRY_BIRDS_RESOURCES
+
+#include <SFML/Graphics.hpp>
+#include <SFML/Audio.hpp>
+#include <memory>
+#include <string>
+#include "atlas.hpp"
+
+// Game objects only store these small ids, the textures, sounds and
+// material parameters behind them are shared by all objects.
+enum class TextureId : unsigned char
+{
+    Bird,
+    Bird2,
+    Bird3,
+    Pig,
+    Box,
+    Ground,
+    Count
+};
+
+enum class SoundId : unsigned char
+{
+    Punch,
+    Pig,
+    Bird,
+    Count
+};
+
+enum class MaterialId : unsigned char
+{
+    Ground,
+    Wall,
+    Pig,
+    Bird,
+    Count
+};
+
+struct Material
+{
+    bool destructable;
+    float destruction_threshold;
+    int destruction_points;
+};
+
+class Resources
+{
+public:
+    static Resources &Get();
+
+    // Sprite showing the whole texture, textures are loaded on first use
+    sf::Sprite GetSprite(TextureId id);
+
+    const Material &GetMaterial(MaterialId id) const;
+
+    // Plays the sound on one of the shared voices, the oldest voice is reused when all are busy
+    void PlaySound(SoundId id, float volume);
+
+    // Starts loading the ground texture and the sounds in the background
+    static void Preload();
+
+    // Headless runs don't touch the audio device at all, the voices are only created by
+    // the first sound played while not muted
+    void SetMuted(bool muted) { muted_ = muted; }
+
+private:
+    Resources();
+
+    const static int voice_count_ = 16; // Well below the OpenAL source limit
+    sf::Texture *ground_texture_ = nullptr;
+    TextureAtlas::Region regions_[static_cast<int>(TextureId::Count)]; // Atlas region of each texture, looked up by name once
+    bool regions_resolved_ = false;
+    const sf::SoundBuffer *sound_buffers_[static_cast<int>(SoundId::Count)] = {};
+    std::unique_ptr<sf::Sound[]> voices_; // Created on the first sound, constructing them opens the audio device
+    int next_voice_ = 0;
+    bool muted_ = false;
+};
+
+#endif // ANGRY_BIRDS_RESOURCES
@@ -0,0 +1,183 @@
+#include "rewind.hpp"
+#include "memory_stats.hpp"
+#include <algorithm>
+
+namespace
+{
+    bool SameState(const BodyState &a, const BodyState &b)
+    {
+        return a.id == b.id && a.position == b.position && a.angle == b.angle && a.linear_velocity == b.linear_velocity &&
+               a.angular_velocity == b.angular_velocity && a.gravity_scale == b.gravity_scale && a.health == b.health &&
+               a.awake == b.awake && a.enabled == b.enabled;
+    }
+}
+
+RewindBuffer::RewindBuffer(size_t max_bytes, int step_interval, int keyframe_interval)
+    : max_bytes_(max_bytes), step_interval_(std::max(1, step_interval)), keyframe_interval_(std::max(1, keyframe_interval))
+{
+}
+
+RewindBuffer::~RewindBuffer()
+{
+    Clear();
+}
+
+void RewindBuffer::Record(Level &level, int steps)
+{
+    steps_ += steps;
+    if (steps_ >= step_interval_)
+    {
+        steps_ = 0;
+        Push(level.CaptureState());
+    }
+}
+
+void RewindBuffer::Push(const LevelState &state)
+{
+    Frame frame;
+    frame.keyframe = frames_.empty() || since_keyframe_ >= keyframe_interval_;
+    if (frame.keyframe)
+    {
+        frame.bodies = state.bodies;
+        keyframe_bodies_ = state.bodies;
+        since_keyframe_ = 0;
+    }
+    else
+    {
+        // Both lists are sorted by id, so one pass finds what changed, appeared or vanished
+        auto base = keyframe_bodies_.begin();
+        for (const auto &body : state.bodies)
+        {
+            while (base != keyframe_bodies_.end() && base->id < body.id)
+            {
+                frame.removed.push_back(base->id);
+                ++base;
+            }
+            if (base != keyframe_bodies_.end() && base->id == body.id)
+            {
+                if (!SameState(*base, body))
+                {
+                    frame.bodies.push_back(body);
+                }
+                ++base;
+            }
+            else
+            {
+                frame.bodies.push_back(body);
+            }
+        }
+        for (; base != keyframe_bodies_.end(); ++base)
+        {
+            frame.removed.push_back(base->id);
+        }
+    }
+    since_keyframe_++;
+
+    frame.scalars = state;
+    frame.scalars.bodies.clear();
+    frame.bodies.shrink_to_fit();
+    frame.bytes = sizeof(Frame) + frame.bodies.size() * sizeof(BodyState) + frame.removed.size() * sizeof(uint32_t) + frame.scalars.birds.size();
+    bytes_ += frame.bytes;
+    memory_stats::Add(MemoryTag::Rewind, frame.bytes);
+    frames_.push_back(std::move(frame));
+
+    // Keyframes are dropped together with their deltas, the newest keyframe stays even if it's over budget
+    while (bytes_ > max_bytes_)
+    {
+        auto next = std::find_if(frames_.begin() + 1, frames_.end(), [](const Frame &f)
+                                 { return f.keyframe; });
+        if (next == frames_.end())
+        {
+            break;
+        }
+        for (auto count = next - frames_.begin(); count > 0; count--)
+        {
+            Drop();
+        }
+    }
+}
+
+void RewindBuffer::Drop()
+{
+    bytes_ -= frames_.front().bytes;
+    memory_stats::Add(MemoryTag::Rewind, -static_cast<long long>(frames_.front().bytes));
+    frames_.pop_front();
+}
+
+bool RewindBuffer::Get(size_t index, LevelState &state) const
+{
+    if (index >= frames_.size())
+    {
+        return false;
+    }
+    size_t key = index;
+    while (!frames_[key].keyframe)
+    {
+        key--;
+    }
+    const Frame &frame = frames_[index];
+    state = frame.scalars;
+    if (key == index)
+    {
+        state.bodies = frame.bodies;
+        return true;
+    }
+
+    // Keyframe bodies with the removed ones left out and the changed ones replaced, still sorted by id
+    const std::vector<BodyState> &base = frames_[key].bodies;
+    state.bodies.clear();
+    state.bodies.reserve(base.size() + frame.bodies.size());
+    auto removed = frame.removed.begin();
+    auto changed = frame.bodies.begin();
+    for (const auto &body : base)
+    {
+        while (changed != frame.bodies.end() && changed->id < body.id)
+        {
+            state.bodies.push_back(*changed++);
+        }
+        if (removed != frame.removed.end() && *removed == body.id)
+        {
+            ++removed;
+        }
+        else if (changed != frame.bodies.end() && changed->id == body.id)
+        {
+            state.bodies.push_back(*changed++);
+        }
+        else
+        {
+            state.bodies.push_back(body);
+        }
+    }
+    state.bodies.insert(state.bodies.end(), changed, frame.bodies.end());
+    return true;
+}
+
+bool RewindBuffer::Restore(Level &level, size_t index)
+{
+    LevelState state;
+    if (!Get(index, state))
+    {
+        return false;
+    }
+    level.RestoreState(state);
+    while (frames_.size() > index + 1)
+    {
+        bytes_ -= frames_.back().bytes;
+        memory_stats::Add(MemoryTag::Rewind, -static_cast<long long>(frames_.back().bytes));
+        frames_.pop_back();
+    }
+    // The newest keyframe may be gone, start over with a fresh one
+    since_keyframe_ = keyframe_interval_;
+    steps_ = 0;
+    return true;
+}
+
+void RewindBuffer::Clear()
+{
+    memory_stats::Add(MemoryTag::Rewind, -static_cast<long long>(bytes_));
+    frames_.clear();
+    keyframe_bodies_.clear();
+    bytes_ = 0;
+    steps_ = 0;
+    since_keyframe_ = 0;
+}
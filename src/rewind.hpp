@@ -0,0 +1,61 @@
+#ifndef ANGRY_BIRDS_REWIND
+#define ANGRY_BIRDS_REWIND
+
+#include "level.hpp"
+#include <deque>
+
+// Ring buffer of level states taken every few steps. Every keyframe_interval-th
+// state is stored whole, the ones in between only store the bodies that differ
+// from that keyframe. When the buffer goes over its memory budget the oldest
+// keyframe is dropped together with the states that depend on it, the newest
+// keyframe is always kept.
+class RewindBuffer
+{
+public:
+    explicit RewindBuffer(size_t max_bytes = 4 * 1024 * 1024, int step_interval = 10, int keyframe_interval = 16);
+    ~RewindBuffer();
+
+    RewindBuffer(const RewindBuffer &) = delete;
+    RewindBuffer &operator=(const RewindBuffer &) = delete;
+
+    // Call after the level has taken steps, captures it whenever another step_interval steps have passed
+    void Record(Level &level, int steps = 1);
+
+    void Push(const LevelState &state);
+
+    // States stored, 0 is the oldest
+    size_t GetCount() const { return frames_.size(); }
+
+    size_t GetBytes() const { return bytes_; }
+
+    // Decodes a stored state, returns false if index is out of range
+    bool Get(size_t index, LevelState &state) const;
+
+    // Restores the level to a stored state and drops the newer ones so play branches off from there
+    bool Restore(Level &level, size_t index);
+
+    void Clear();
+
+private:
+    struct Frame
+    {
+        bool keyframe;
+        std::vector<BodyState> bodies;  // All bodies in a keyframe, otherwise the ones that differ from it
+        std::vector<uint32_t> removed;  // Ids in the keyframe that are gone
+        LevelState scalars;             // Everything but the bodies
+        size_t bytes;
+    };
+
+    void Drop();
+
+    size_t max_bytes_;
+    int step_interval_;
+    int keyframe_interval_;
+    int steps_ = 0;
+    int since_keyframe_ = 0;
+    std::deque<Frame> frames_;
+    std::vector<BodyState> keyframe_bodies_; // Bodies of the newest keyframe, the base of new deltas
+    size_t bytes_ = 0;
+};
+
+#endif // ANGRY_BIRDS_REWIND
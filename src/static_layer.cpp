@@ -0,0 +1,172 @@
+#include "static_layer.hpp"
+#include "memory_stats.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+    const unsigned tile_size = 1024;
+    // At 4 MB per tile, tiles out of view are released beyond this
+    const int max_baked_tiles = 6;
+
+    sf::FloatRect ViewRect(const sf::View &view)
+    {
+        sf::Vector2f size = view.getSize();
+        sf::Vector2f center = view.getCenter();
+        return sf::FloatRect(center.x - size.x / 2, center.y - size.y / 2, size.x, size.y);
+    }
+}
+
+void StaticLayer::Reset(const sf::FloatRect &bounds, const std::function<void(sf::RenderTarget &)> &draw)
+{
+    Clear();
+    bounds_ = content_ = bounds;
+    draw_ = draw;
+    size_ = std::min(tile_size, sf::Texture::getMaximumSize());
+    int columns = static_cast<int>(std::ceil(bounds.width / size_));
+    int rows = static_cast<int>(std::ceil(bounds.height / size_));
+    tiles_.resize(rows * columns);
+    for (int row = 0; row < rows; row++)
+    {
+        for (int column = 0; column < columns; column++)
+        {
+            tiles_[row * columns + column].rect = sf::FloatRect(bounds.left + column * size_, bounds.top + row * size_, size_, size_);
+        }
+    }
+}
+
+void StaticLayer::SetContent(const sf::FloatRect &content)
+{
+    content_ = content;
+    for (auto &tile : tiles_)
+    {
+        if (!tile.rect.intersects(content_))
+        {
+            Release(tile);
+        }
+    }
+}
+
+void StaticLayer::Invalidate(const sf::FloatRect &rect)
+{
+    float left = std::min(content_.left, rect.left);
+    float top = std::min(content_.top, rect.top);
+    content_ = sf::FloatRect(left, top, std::max(content_.left + content_.width, rect.left + rect.width) - left,
+                             std::max(content_.top + content_.height, rect.top + rect.height) - top);
+    for (auto &tile : tiles_)
+    {
+        if (tile.rect.intersects(rect))
+        {
+            tile.dirty = true;
+        }
+    }
+}
+
+void StaticLayer::Invalidate()
+{
+    for (auto &tile : tiles_)
+    {
+        tile.dirty = true;
+    }
+}
+
+void StaticLayer::Clear()
+{
+    for (auto &tile : tiles_)
+    {
+        Release(tile);
+    }
+    tiles_.clear();
+}
+
+bool StaticLayer::Covers(const sf::View &view) const
+{
+    sf::FloatRect rect = ViewRect(view);
+    return !IsEmpty() && rect.left >= bounds_.left && rect.top >= bounds_.top &&
+           rect.left + rect.width <= bounds_.left + bounds_.width &&
+           rect.top + rect.height <= bounds_.top + bounds_.height;
+}
+
+void StaticLayer::Draw(sf::RenderTarget &target)
+{
+    frame_++;
+    sf::FloatRect visible = ViewRect(target.getView());
+    for (auto &tile : tiles_)
+    {
+        if (!tile.rect.intersects(visible) || !tile.rect.intersects(content_))
+        {
+            continue;
+        }
+        tile.last_drawn = frame_;
+        if ((tile.dirty || !tile.texture) && !Bake(tile))
+        {
+            continue;
+        }
+        target.draw(tile.sprite);
+    }
+
+    // Release the tiles that have been out of view the longest
+    int baked = CountBakedTiles();
+    while (baked > max_baked_tiles)
+    {
+        Tile *oldest = nullptr;
+        for (auto &tile : tiles_)
+        {
+            if (tile.texture && tile.last_drawn != frame_ && (!oldest || tile.last_drawn < oldest->last_drawn))
+            {
+                oldest = &tile;
+            }
+        }
+        if (!oldest)
+        {
+            break; // Everything baked is in view
+        }
+        Release(*oldest);
+        baked--;
+    }
+}
+
+int StaticLayer::CountBakedTiles() const
+{
+    int baked = 0;
+    for (const auto &tile : tiles_)
+    {
+        baked += tile.texture != nullptr;
+    }
+    return baked;
+}
+
+bool StaticLayer::Bake(Tile &tile)
+{
+    if (!tile.texture)
+    {
+        tile.texture.reset(new sf::RenderTexture());
+        if (!tile.texture->create(size_, size_))
+        {
+            std::cerr << "Static layer: failed to create a " << size_ << "x" << size_ << " tile" << std::endl;
+            tile.texture.reset();
+            return false;
+        }
+        memory_stats::Add(MemoryTag::Textures, 4LL * size_ * size_);
+        tile.sprite.setTexture(tile.texture->getTexture());
+        tile.sprite.setPosition(tile.rect.left, tile.rect.top);
+    }
+    tile.texture->setView(sf::View(tile.rect));
+    tile.texture->clear(sf::Color::Transparent);
+    draw_(*tile.texture);
+    tile.texture->display();
+    tile.dirty = false;
+    return true;
+}
+
+void StaticLayer::Release(Tile &tile)
+{
+    if (tile.texture)
+    {
+        sf::Vector2u size = tile.texture->getSize();
+        memory_stats::Add(MemoryTag::Textures, -4LL * size.x * size.y);
+        tile.texture.reset();
+    }
+    tile.dirty = true;
+}
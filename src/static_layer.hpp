@@ -0,0 +1,68 @@
+#ifndef ANGRY_BIRDS_STATIC_LAYER
+#define ANGRY_BIRDS_STATIC_LAYER
+
+#include <SFML/Graphics.hpp>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Everything that never moves (background, ground, slingshot, static bodies) is
+// rendered into a grid of textures. Each frame only the tiles that intersect the
+// view are drawn, one draw call and one layer of fill per tile.
+//
+// Tiles are baked lazily the first time the view reaches them and only where
+// something is drawn, so a level that is never scrolled around only pays for
+// the few tiles around the slingshot. Tiles far from the view are released
+// again once more than a handful are baked.
+class StaticLayer
+{
+public:
+    // Sets the area covered by the tiles and how to draw it. Nothing is rendered yet.
+    void Reset(const sf::FloatRect &bounds, const std::function<void(sf::RenderTarget &)> &draw);
+
+    // Part of the area that has something drawn in it, tiles outside it are never baked
+    void SetContent(const sf::FloatRect &content);
+
+    // Something was drawn or removed inside rect, the tiles it touches render again when next
+    // in view. The content grows to include rect.
+    void Invalidate(const sf::FloatRect &rect);
+
+    // Makes every tile render again when next in view
+    void Invalidate();
+
+    void Clear();
+
+    ~StaticLayer() { Clear(); }
+
+    bool IsEmpty() const { return tiles_.empty(); }
+
+    // True if the whole view lies inside the tiled area
+    bool Covers(const sf::View &view) const;
+
+    // Bakes the visible tiles that aren't up to date and draws them
+    void Draw(sf::RenderTarget &target);
+
+    int CountBakedTiles() const;
+
+private:
+    struct Tile
+    {
+        sf::FloatRect rect;
+        std::unique_ptr<sf::RenderTexture> texture;
+        sf::Sprite sprite;
+        bool dirty = true;
+        unsigned last_drawn = 0; // Frame the tile was last visible on
+    };
+
+    bool Bake(Tile &tile);
+    void Release(Tile &tile);
+
+    sf::FloatRect bounds_;
+    sf::FloatRect content_;
+    std::function<void(sf::RenderTarget &)> draw_;
+    std::vector<Tile> tiles_;
+    unsigned size_ = 0; // Tile width and height in pixels
+    unsigned frame_ = 0;
+};
+
+#endif // ANGRY_BIRDS_STATIC_LAYER
@@ -0,0 +1,111 @@
+#include "task_pool.hpp"
+#include <algorithm>
+
+namespace
+{
+    const unsigned max_workers = 7;
+}
+
+TaskPool &TaskPool::Get()
+{
+    static TaskPool pool;
+    return pool;
+}
+
+TaskPool::TaskPool()
+{
+    unsigned threads = std::thread::hardware_concurrency();
+    unsigned worker_count = std::min(max_workers, threads > 1 ? threads - 1 : 0);
+    for (unsigned i = 0; i < worker_count; i++)
+    {
+        workers_.emplace_back(&TaskPool::Work, this);
+    }
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    queued_.notify_all();
+    for (auto &worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+bool TaskPool::Take(Batch *&batch, int &index)
+{
+    if (batches_.empty())
+    {
+        return false;
+    }
+    batch = batches_.front();
+    index = batch->next++;
+    // Once every task has been started the batch leaves the queue, it's gone as soon as the last one is done
+    if (batch->next == batch->count)
+    {
+        batches_.pop_front();
+    }
+    return true;
+}
+
+void TaskPool::Run(int count, const std::function<void(int)> &task)
+{
+    if (count <= 1 || workers_.empty())
+    {
+        for (int i = 0; i < count; i++)
+        {
+            task(i);
+        }
+        return;
+    }
+
+    Batch own;
+    own.task = &task;
+    own.count = count;
+    std::unique_lock<std::mutex> lock(mutex_);
+    batches_.push_back(&own);
+    queued_.notify_all();
+
+    // Help out until our own batch has been handed out, earlier batches included
+    Batch *batch;
+    int index;
+    while (own.next < own.count && Take(batch, index))
+    {
+        lock.unlock();
+        (*batch->task)(index);
+        lock.lock();
+        if (++batch->done == batch->count)
+        {
+            finished_.notify_all();
+        }
+    }
+    finished_.wait(lock, [&own]()
+                   { return own.done == own.count; });
+}
+
+void TaskPool::Work()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        Batch *batch;
+        int index;
+        queued_.wait(lock, [this, &batch, &index]()
+                     { return stop_ || Take(batch, index); });
+        if (stop_)
+        {
+            return;
+        }
+        lock.unlock();
+        (*batch->task)(index);
+        lock.lock();
+        // The batch belongs to the thread waiting in Run, it's gone once done reaches count
+        if (++batch->done == batch->count)
+        {
+            finished_.notify_all();
+        }
+    }
+}
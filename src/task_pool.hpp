@@ -0,0 +1,53 @@
+#ifndef ANGRY_BIRDS_TASK_POOL
+#define ANGRY_BIRDS_TASK_POOL
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Worker threads shared by everything that splits a short piece of work into
+// parallel tasks, like stepping the shards of an IslandWorld. Run can be called
+// from several threads at once, their batches are worked through in turn.
+class TaskPool
+{
+public:
+    static TaskPool &Get();
+
+    TaskPool(const TaskPool &) = delete;
+    TaskPool &operator=(const TaskPool &) = delete;
+
+    // Runs task(0) ... task(count - 1) and returns once all of them are done. The
+    // calling thread runs tasks too, so a busy pool only makes this slower.
+    void Run(int count, const std::function<void(int)> &task);
+
+    // Workers plus the calling thread
+    int GetThreadCount() const { return static_cast<int>(workers_.size()) + 1; }
+
+private:
+    struct Batch
+    {
+        const std::function<void(int)> *task;
+        int count;
+        int next = 0; // First task nobody has started yet
+        int done = 0;
+    };
+
+    TaskPool();
+    ~TaskPool();
+    void Work();
+
+    // Takes the next task of the front batch, false if there is none. Needs the lock.
+    bool Take(Batch *&batch, int &index);
+
+    std::deque<Batch *> batches_;
+    std::mutex mutex_;
+    std::condition_variable queued_;
+    std::condition_variable finished_;
+    bool stop_ = false;
+    std::vector<std::thread> workers_; // Last so everything above exists before the threads start
+};
+
+#endif // ANGRY_BIRDS_TASK_POOL
@@ -0,0 +1,197 @@
+#include "telemetry.hpp"
+#include "converters.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+    const std::chrono::seconds flush_interval(5);
+    const long long max_file_bytes = 1024 * 1024; // A full file moves the writing on to the next slot
+    const int file_slot_count = 4;
+    const float bucket_ms = 0.05f; // Step times are binned this finely for the percentiles
+    const int bucket_count = 1000; // The last bucket takes everything from 50 ms up
+
+    // Step time below which the fraction of all steps fall
+    float Percentile(const std::vector<uint32_t> &histogram, int steps, float fraction)
+    {
+        uint32_t rank = static_cast<uint32_t>(fraction * steps);
+        uint32_t seen = 0;
+        for (size_t i = 0; i < histogram.size(); i++)
+        {
+            seen += histogram[i];
+            if (seen > rank)
+            {
+                return (i + 1) * bucket_ms;
+            }
+        }
+        return 0;
+    }
+
+    void WriteJson(std::ostream &output, const AttemptRecord &record)
+    {
+        output << "{\"level_hash\":\"" << std::hex << std::setw(16) << std::setfill('0') << record.level_hash << std::dec
+               << "\",\"level\":" << record.level_number << ",\"started\":" << record.started << ",\"throws\":" << record.throws
+               << ",\"settle_s\":[";
+        for (int i = 0; i < std::min(record.throws, max_recorded_throws); i++)
+        {
+            output << (i > 0 ? "," : "") << record.settle_seconds[i];
+        }
+        output << "],\"steps\":" << record.steps << ",\"step_ms\":{\"p50\":" << record.step_ms_p50 << ",\"p90\":" << record.step_ms_p90
+               << ",\"p99\":" << record.step_ms_p99 << ",\"max\":" << record.step_ms_max << "},\"peak_bodies\":" << record.peak_bodies
+               << ",\"peak_contacts\":" << record.peak_contacts << ",\"score\":" << record.score << ",\"stars\":" << record.stars
+               << ",\"cleared\":" << (record.cleared ? "true" : "false") << ",\"finished\":" << (record.finished ? "true" : "false")
+               << "}\n";
+    }
+}
+
+Telemetry::Telemetry(const std::string &directory)
+    : directory_(directory), step_histogram_(bucket_count, 0), head_(0), tail_(0), dropped_(0), thread_(&Telemetry::Run, this)
+{
+}
+
+Telemetry::~Telemetry()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+void Telemetry::BeginAttempt(uint64_t level_hash, int level_number)
+{
+    current_ = AttemptRecord();
+    current_.level_hash = level_hash;
+    current_.level_number = level_number;
+    current_.started = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    std::fill(step_histogram_.begin(), step_histogram_.end(), 0);
+    throw_step_ = -1;
+    recording_ = true;
+}
+
+void Telemetry::RecordSteps(int steps, sf::Time time, int bodies, int contacts)
+{
+    if (!recording_ || steps <= 0)
+    {
+        return;
+    }
+    float step_ms = time.asSeconds() * 1000 / steps;
+    int bucket = std::min(bucket_count - 1, static_cast<int>(step_ms / bucket_ms));
+    step_histogram_[bucket] += steps;
+    current_.steps += steps;
+    current_.step_ms_max = std::max(current_.step_ms_max, step_ms);
+    current_.peak_bodies = std::max(current_.peak_bodies, bodies);
+    current_.peak_contacts = std::max(current_.peak_contacts, contacts);
+}
+
+void Telemetry::RecordThrow()
+{
+    if (!recording_)
+    {
+        return;
+    }
+    if (current_.throws < max_recorded_throws)
+    {
+        current_.settle_seconds[current_.throws] = -1;
+    }
+    current_.throws++;
+    throw_step_ = current_.steps;
+}
+
+void Telemetry::RecordSettled()
+{
+    if (!recording_ || throw_step_ < 0)
+    {
+        return;
+    }
+    if (current_.throws <= max_recorded_throws)
+    {
+        current_.settle_seconds[current_.throws - 1] = (current_.steps - throw_step_) * time_step;
+    }
+    throw_step_ = -1;
+}
+
+void Telemetry::EndAttempt(int score, int stars, bool cleared, bool finished)
+{
+    if (!recording_)
+    {
+        return;
+    }
+    recording_ = false;
+    current_.score = score;
+    current_.stars = stars;
+    current_.cleared = cleared;
+    current_.finished = finished;
+    current_.step_ms_p50 = Percentile(step_histogram_, current_.steps, 0.5f);
+    current_.step_ms_p90 = Percentile(step_histogram_, current_.steps, 0.9f);
+    current_.step_ms_p99 = Percentile(step_histogram_, current_.steps, 0.99f);
+
+    // A full ring means the writer is stuck, the record is dropped rather than waiting for it
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= ring_size)
+    {
+        dropped_++;
+        return;
+    }
+    ring_[head % ring_size] = current_;
+    head_.store(head + 1, std::memory_order_release);
+}
+
+void Telemetry::Run()
+{
+    utils::MakeDirectory(directory_);
+    // Continue in the slot the previous run wrote to last
+    std::ifstream index(directory_ + "/telemetry.txt");
+    int slot;
+    if (index >> slot && slot >= 0 && slot < file_slot_count)
+    {
+        slot_ = slot;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_)
+    {
+        wake_.wait_for(lock, flush_interval, [this]
+                       { return stopping_; });
+        lock.unlock();
+        Flush();
+        lock.lock();
+    }
+}
+
+void Telemetry::Flush()
+{
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t head = head_.load(std::memory_order_acquire);
+    if (tail == head)
+    {
+        return;
+    }
+    std::stringstream lines;
+    for (; tail != head; tail++)
+    {
+        WriteJson(lines, ring_[tail % ring_size]);
+    }
+    tail_.store(tail, std::memory_order_release);
+
+    std::string path = directory_ + "/telemetry" + std::to_string(slot_) + ".jsonl";
+    if (utils::FileSize(path) >= max_file_bytes)
+    {
+        slot_ = (slot_ + 1) % file_slot_count;
+        path = directory_ + "/telemetry" + std::to_string(slot_) + ".jsonl";
+        std::remove(path.c_str());
+        std::ofstream(directory_ + "/telemetry.txt") << slot_ << std::endl;
+    }
+    std::ofstream file(path, std::ios::app);
+    file << lines.str();
+    if (!file.good())
+    {
+        std::cerr << "Telemetry: failed to write " << path << std::endl;
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef ANGRY_BIRDS_TELEMETRY
+#define ANGRY_BIRDS_TELEMETRY
+
+#include <SFML/System.hpp>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+const int max_recorded_throws = 8;
+
+// One play of a level, from loading it until it ends or another level is loaded
+struct AttemptRecord
+{
+    uint64_t level_hash = 0; // level_asset::ContentHash of the level file
+    int level_number = 0;
+    int64_t started = 0; // Seconds since the epoch
+    int throws = 0;
+    float settle_seconds[max_recorded_throws] = {}; // Simulated time from each throw until the world settled, -1 if it didn't
+    int steps = 0;
+    float step_ms_p50 = 0;
+    float step_ms_p90 = 0;
+    float step_ms_p99 = 0;
+    float step_ms_max = 0;
+    int peak_bodies = 0;
+    int peak_contacts = 0;
+    int score = 0;
+    int stars = 0;
+    bool cleared = false;  // Every pig was destroyed
+    bool finished = false; // The level ended, otherwise it was left for another one
+};
+
+// Collects an AttemptRecord per attempt and appends them as JSON lines to files
+// rotating through a few slots in directory. The game loop only hands finished
+// records over through a lock-free ring, a background thread writes them out
+// every few seconds, so recording never waits for the disk or a lock.
+class Telemetry
+{
+public:
+    explicit Telemetry(const std::string &directory = "telemetry");
+    ~Telemetry(); // Writes everything recorded before returning
+
+    Telemetry(const Telemetry &) = delete;
+    Telemetry &operator=(const Telemetry &) = delete;
+
+    // The calls below are for the game loop only. None of them lock or allocate.
+
+    void BeginAttempt(uint64_t level_hash, int level_number);
+
+    // Steps taken this frame and how long they took, with the world's size after them
+    void RecordSteps(int steps, sf::Time time, int bodies, int contacts);
+
+    void RecordThrow();
+
+    // The world came to rest after the latest throw
+    void RecordSettled();
+
+    void EndAttempt(int score, int stars, bool cleared, bool finished);
+
+    bool IsRecording() const { return recording_; }
+
+    // Records lost because the writer fell behind
+    size_t GetDropped() const { return dropped_; }
+
+private:
+    static const size_t ring_size = 64;
+
+    void Run();
+
+    // Takes everything out of the ring and appends it to the current file
+    void Flush();
+
+    std::string directory_;
+
+    // Attempt in progress, only touched by the game loop
+    AttemptRecord current_;
+    bool recording_ = false;
+    int throw_step_ = -1; // current_.steps at the latest throw, -1 once it has settled
+    std::vector<uint32_t> step_histogram_;
+
+    // Single producer, single consumer: the game loop advances head_, the writer tail_
+    std::array<AttemptRecord, ring_size> ring_;
+    std::atomic<size_t> head_;
+    std::atomic<size_t> tail_;
+    std::atomic<size_t> dropped_;
+
+    // Writer thread
+    int slot_ = 0;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::thread thread_; // Last so everything above exists before the thread starts
+};
+
+#endif // ANGRY_BIRDS_TELEMETRY
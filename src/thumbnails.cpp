@@ -0,0 +1,226 @@
+#include "thumbnails.hpp"
+#include "converters.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <iomanip>
+
+namespace
+{
+    const unsigned thumbnail_width = viewwidth / 5;
+    const unsigned thumbnail_height = viewheight / 5;
+
+    std::string ThumbnailPath(uint64_t source_hash)
+    {
+        std::stringstream path;
+        path << cache_directory << "/thumbnails/" << std::hex << std::setw(16) << std::setfill('0') << source_hash << ".png";
+        return path.str();
+    }
+
+    sf::Color BodyColor(char type)
+    {
+        switch (type)
+        {
+        case 'G':
+            return sf::Color(90, 160, 60);
+        case 'W':
+            return sf::Color(170, 120, 60);
+        case 'P':
+            return sf::Color(120, 210, 70);
+        default: // Birds
+            return sf::Color(210, 40, 40);
+        }
+    }
+
+    // Fills the pixels whose centers are inside the shape, polygons are convex in Box2D
+    void FillBody(sf::Image &image, const BodyRecord &body, float pixels_per_meter, float top)
+    {
+        b2Rot rotation(body.angle);
+        auto to_pixels = [&](b2Vec2 local)
+        {
+            b2Vec2 world = body.position + b2Mul(rotation, local);
+            return sf::Vector2f(world.x * pixels_per_meter, (top - world.y) * pixels_per_meter);
+        };
+
+        std::vector<sf::Vector2f> points;
+        float radius = 0;
+        sf::Vector2f center = to_pixels(body.center);
+        if (body.shape_type == b2Shape::Type::e_polygon)
+        {
+            for (int i = 0; i < body.vertex_count; i++)
+            {
+                points.push_back(to_pixels(body.vertices[i]));
+            }
+        }
+        else
+        {
+            radius = body.radius * pixels_per_meter;
+            points = {center - sf::Vector2f(radius, radius), center + sf::Vector2f(radius, radius)};
+        }
+        if (points.empty())
+        {
+            return;
+        }
+
+        float min_x = points[0].x, max_x = points[0].x, min_y = points[0].y, max_y = points[0].y;
+        for (auto p : points)
+        {
+            min_x = std::min(min_x, p.x);
+            max_x = std::max(max_x, p.x);
+            min_y = std::min(min_y, p.y);
+            max_y = std::max(max_y, p.y);
+        }
+        int x0 = std::max(0, static_cast<int>(min_x)), x1 = std::min(static_cast<int>(image.getSize().x) - 1, static_cast<int>(max_x));
+        int y0 = std::max(0, static_cast<int>(min_y)), y1 = std::min(static_cast<int>(image.getSize().y) - 1, static_cast<int>(max_y));
+
+        sf::Color color = BodyColor(body.type);
+        for (int y = y0; y <= y1; y++)
+        {
+            for (int x = x0; x <= x1; x++)
+            {
+                sf::Vector2f p(x + 0.5f, y + 0.5f);
+                bool inside = true;
+                if (radius > 0)
+                {
+                    sf::Vector2f d = p - center;
+                    inside = d.x * d.x + d.y * d.y <= radius * radius;
+                }
+                else
+                {
+                    // Inside if on the same side of every edge, whichever the winding
+                    int sides = 0;
+                    for (size_t i = 0; i < points.size(); i++)
+                    {
+                        sf::Vector2f a = points[i], b = points[(i + 1) % points.size()];
+                        float cross = (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+                        sides += cross >= 0 ? 1 : -1;
+                    }
+                    inside = std::abs(sides) == static_cast<int>(points.size());
+                }
+                if (inside)
+                {
+                    image.setPixel(x, y, color);
+                }
+            }
+        }
+    }
+}
+
+ThumbnailCache::ThumbnailCache() : thread_(&ThumbnailCache::Run, this)
+{
+}
+
+ThumbnailCache::~ThumbnailCache()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        jobs_.clear();
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+void ThumbnailCache::Request(const std::string &level_path, uint64_t known_hash)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // A level already waiting is moved to the front instead of being queued twice
+        auto it = std::find_if(jobs_.begin(), jobs_.end(), [&level_path](const Job &job)
+                               { return job.path == level_path; });
+        if (it != jobs_.end())
+        {
+            jobs_.erase(it);
+        }
+        jobs_.push_front({level_path, known_hash});
+    }
+    wake_.notify_one();
+}
+
+std::vector<ThumbnailCache::Thumbnail> ThumbnailCache::Poll()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<Thumbnail> done;
+    done.swap(done_);
+    return done;
+}
+
+bool ThumbnailCache::IsBusy()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !jobs_.empty() || working_ > 0;
+}
+
+void ThumbnailCache::Run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        wake_.wait(lock, [this]
+                   { return stopping_ || !jobs_.empty(); });
+        if (stopping_)
+        {
+            return;
+        }
+        Job job = jobs_.front();
+        jobs_.pop_front();
+        working_++;
+
+        lock.unlock();
+        Thumbnail thumbnail = Load(job);
+        lock.lock();
+
+        working_--;
+        done_.push_back(std::move(thumbnail));
+    }
+}
+
+ThumbnailCache::Thumbnail ThumbnailCache::Load(const Job &job) const
+{
+    Thumbnail thumbnail;
+    thumbnail.path = job.path;
+    std::ifstream file(job.path);
+    std::stringstream text;
+    text << file.rdbuf();
+    thumbnail.source_hash = level_asset::ContentHash(text.str());
+    if (thumbnail.source_hash == job.known_hash)
+    {
+        return thumbnail;
+    }
+
+    std::string cached = ThumbnailPath(thumbnail.source_hash);
+    if (utils::FileSize(cached) > 0 && thumbnail.image.loadFromFile(cached))
+    {
+        return thumbnail;
+    }
+
+    std::vector<std::string> errors;
+    LevelAsset asset = level_asset::Parse(text, errors);
+    thumbnail.image = Render(asset, thumbnail_width, thumbnail_height);
+    utils::MakeDirectory(cache_directory);
+    utils::MakeDirectory(cache_directory + "/thumbnails");
+    thumbnail.image.saveToFile(cached);
+    return thumbnail;
+}
+
+sf::Image ThumbnailCache::Render(const LevelAsset &asset, unsigned width, unsigned height)
+{
+    // Show at least the starting view and everything right of it up to the last body
+    float right = viewwidth / scale;
+    for (const auto &body : asset.bodies)
+    {
+        if (body.type != 'G')
+        {
+            right = std::max(right, body.position.x + 2);
+        }
+    }
+    float pixels_per_meter = width / right;
+    float top = height / pixels_per_meter - 1; // Leave a meter of the ground visible
+
+    sf::Image image;
+    image.create(width, height, sf::Color(150, 200, 240));
+    for (const auto &body : asset.bodies)
+    {
+        FillBody(image, body, pixels_per_meter, top);
+    }
+    return image;
+}
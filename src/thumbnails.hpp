@@ -0,0 +1,64 @@
+#ifndef ANGRY_BIRDS_THUMBNAILS
+#define ANGRY_BIRDS_THUMBNAILS
+
+#include "level_asset.hpp"
+#include <SFML/Graphics.hpp>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Level preview images drawn from the level's bodies. Thumbnails are cached as
+// png files named after the content hash of the level, so an edited level gets
+// a new one. Reading, hashing and drawing happen on a background thread.
+class ThumbnailCache
+{
+public:
+    struct Thumbnail
+    {
+        std::string path; // Level file
+        uint64_t source_hash;
+        sf::Image image; // Left empty if the thumbnail the caller has is still up to date
+    };
+
+    ThumbnailCache();
+    ~ThumbnailCache();
+
+    ThumbnailCache(const ThumbnailCache &) = delete;
+    ThumbnailCache &operator=(const ThumbnailCache &) = delete;
+
+    // Queues a thumbnail, never blocks. known_hash is the hash of the thumbnail
+    // the caller already has, or 0. The newest requests are served first.
+    void Request(const std::string &level_path, uint64_t known_hash = 0);
+
+    // Takes the thumbnails finished since the last call
+    std::vector<Thumbnail> Poll();
+
+    // True while requests are waiting or being worked on
+    bool IsBusy();
+
+    // Draws the bodies of the level from above the slingshot to its rightmost body
+    static sf::Image Render(const LevelAsset &asset, unsigned width, unsigned height);
+
+private:
+    struct Job
+    {
+        std::string path;
+        uint64_t known_hash;
+    };
+
+    void Run();
+    Thumbnail Load(const Job &job) const;
+
+    std::deque<Job> jobs_;
+    std::vector<Thumbnail> done_;
+    int working_ = 0;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::thread thread_; // Last so everything above exists before the thread starts
+};
+
+#endif // ANGRY_BIRDS_THUMBNAILS
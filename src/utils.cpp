@@ -1,5 +1,21 @@
 #include "utils.hpp"
 
+#include <algorithm>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#define make_dir(path) _mkdir(path)
+#define stat_file _stat
+#else
+#include <dirent.h>
+#define make_dir(path) mkdir(path, 0755)
+#define stat_file stat
+#endif
+
 std::istream &operator>>(std::istream &input, b2Vec2 &vector)
 {
     float x, y;
@@ -98,4 +114,85 @@ namespace utils
     {
         return std::get<1>(a) < std::get<1>(b);
     }
-}
\ No newline at end of file
+
+    long FileSize(const std::string &filename)
+    {
+        std::ifstream file(filename, std::ios::binary | std::ios::ate);
+        if (!file.good())
+        {
+            return -1;
+        }
+        return static_cast<long>(file.tellg());
+    }
+
+    void MakeDirectory(const std::string &path)
+    {
+        make_dir(path.c_str());
+    }
+
+    long long FileModified(const std::string &filename)
+    {
+        struct stat_file info;
+        if (stat_file(filename.c_str(), &info) != 0)
+        {
+            return -1;
+        }
+        return static_cast<long long>(info.st_mtime);
+    }
+
+    std::vector<std::string> ListFiles(const std::string &directory, const std::string &suffix)
+    {
+        std::vector<std::string> names;
+#ifdef _WIN32
+        _finddata_t data;
+        intptr_t handle = _findfirst((directory + "/*" + suffix).c_str(), &data);
+        if (handle != -1)
+        {
+            do
+            {
+                names.push_back(data.name);
+            } while (_findnext(handle, &data) == 0);
+            _findclose(handle);
+        }
+#else
+        DIR *dir = opendir(directory.c_str());
+        if (dir != nullptr)
+        {
+            while (dirent *entry = readdir(dir))
+            {
+                std::string name = entry->d_name;
+                if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+                {
+                    names.push_back(name);
+                }
+            }
+            closedir(dir);
+        }
+#endif
+        // Shorter names first so that level2 comes before level10
+        std::sort(names.begin(), names.end(), [](const std::string &a, const std::string &b)
+                  { return a.size() != b.size() ? a.size() < b.size() : a < b; });
+        std::vector<std::string> paths;
+        for (const auto &name : names)
+        {
+            paths.push_back(directory + "/" + name);
+        }
+        return paths;
+    }
+
+    void AppendQuad(sf::VertexArray &vertices, const sf::Sprite &sprite)
+    {
+        sf::IntRect rc = sprite.getTextureRect();
+        const sf::Transform &transform = sprite.getTransform();
+        float left = static_cast<float>(rc.left);
+        float top = static_cast<float>(rc.top);
+        float right = left + rc.width;
+        float bottom = top + rc.height;
+        sf::Color color = sprite.getColor();
+
+        vertices.append(sf::Vertex(transform.transformPoint(0, 0), color, sf::Vector2f(left, top)));
+        vertices.append(sf::Vertex(transform.transformPoint(static_cast<float>(rc.width), 0), color, sf::Vector2f(right, top)));
+        vertices.append(sf::Vertex(transform.transformPoint(static_cast<float>(rc.width), static_cast<float>(rc.height)), color, sf::Vector2f(right, bottom)));
+        vertices.append(sf::Vertex(transform.transformPoint(0, static_cast<float>(rc.height)), color, sf::Vector2f(left, bottom)));
+    }
+}
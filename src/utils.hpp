@@ -2,6 +2,7 @@
 #include <string>
 #include <fstream>
 #include <sstream>
+#include <vector>
 #include <box2d/box2d.h>
 #include "converters.hpp"
 
@@ -18,4 +19,19 @@ namespace utils
     b2Vec2 DimensionsFromPolygon(const b2PolygonShape *shape);
 
     bool CmpHighScore(const std::tuple<std::string, int> &a, const std::tuple<std::string, int> &b);
+
+    // Returns the size of the file in bytes or -1 if it can't be opened
+    long FileSize(const std::string &filename);
+
+    // Last modification time of the file in seconds or -1 if it doesn't exist
+    long long FileModified(const std::string &filename);
+
+    // Creates the directory if it doesn't exist yet
+    void MakeDirectory(const std::string &path);
+
+    // Paths of the files in the directory ending with suffix, in natural order
+    std::vector<std::string> ListFiles(const std::string &directory, const std::string &suffix);
+
+    // Appends the sprite as a transformed quad so that many sprites sharing a texture can be drawn at once
+    void AppendQuad(sf::VertexArray &vertices, const sf::Sprite &sprite);
 }
\ No newline at end of file
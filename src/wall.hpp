@@ -6,18 +6,8 @@
 class Wall : public Object
 {
 public:
-    Wall(b2Body *body, float b2_w, float b2_h) : Object("resources/images/box.png", body)
-    {
-        int w = sprite_.getTextureRect().width;
-        int h = sprite_.getTextureRect().height;
-
-        sprite_.setScale(b2_w * 2.0f * scale / (1.0f * w), b2_h * 2.0f * scale / (1.0f * h));
-
-        sprite_.setOrigin(w / 2.f, h / 2.f);
-
-        destruction_threshold_ = 600.f;
-        destructable_ = true;
-    };
+    Wall(b2Body *body, float b2_w, float b2_h)
+        : Object(body, TextureId::Box, SoundId::Punch, MaterialId::Wall, b2_w, b2_h){};
 
     char GetType() { return 'W'; };
 
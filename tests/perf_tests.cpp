@@ -0,0 +1,362 @@
+// Performance regression gate: times fixed workloads on the shipped levels and on
+// generated ones, compares them to a stored baseline and fails when one is slower
+// than the baseline allows.
+#include "../src/level.hpp"
+#include "../src/utils.hpp"
+#include "../src/resources.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+
+namespace
+{
+    const int trials = 5; // The fastest trial counts, the others absorb noise
+    const int skipped = 77; // Exit code CTest reports as a skipped test, see SKIP_RETURN_CODE
+
+    struct Options
+    {
+        std::string baseline;
+        std::string output;
+        float tolerance = 0.25f; // Allowed slowdown, 0.25 = 25 %
+        bool update_baseline = false;
+    };
+
+    struct Result
+    {
+        std::string name;
+        double ms;
+        double baseline_ms; // Negative if the baseline doesn't have this workload
+        bool passed;
+    };
+
+    void PrintUsage()
+    {
+        std::cerr << "Usage: perf_tests [options]" << std::endl
+                  << "  --baseline FILE     baseline timings to compare against" << std::endl
+                  << "  --tolerance X       allowed slowdown as a fraction (default 0.25)" << std::endl
+                  << "  --output FILE       write the results as JSON to FILE" << std::endl
+                  << "  --update-baseline   write the timings of this run to the baseline file" << std::endl;
+    }
+
+    bool ParseOptions(int argc, char *argv[], Options &options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+            if (arg == "--baseline" && has_value)
+            {
+                options.baseline = argv[++i];
+            }
+            else if (arg == "--tolerance" && has_value)
+            {
+                options.tolerance = static_cast<float>(std::atof(argv[++i]));
+            }
+            else if (arg == "--output" && has_value)
+            {
+                options.output = argv[++i];
+            }
+            else if (arg == "--update-baseline")
+            {
+                options.update_baseline = true;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return !options.update_baseline || !options.baseline.empty();
+    }
+
+    // Reads a flat {"name": milliseconds, ...} object
+    std::map<std::string, double> ReadBaseline(const std::string &filename)
+    {
+        std::map<std::string, double> baseline;
+        std::ifstream file(filename);
+        std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        size_t pos = 0;
+        while ((pos = text.find('"', pos)) != std::string::npos)
+        {
+            size_t end = text.find('"', pos + 1);
+            size_t colon = text.find(':', end);
+            if (end == std::string::npos || colon == std::string::npos)
+            {
+                break;
+            }
+            baseline[text.substr(pos + 1, end - pos - 1)] = std::atof(text.c_str() + colon + 1);
+            pos = text.find_first_of(",}", colon);
+        }
+        return baseline;
+    }
+
+    void WriteBaseline(const std::string &filename, const std::vector<Result> &results)
+    {
+        std::ofstream file(filename);
+        file << "{" << std::endl;
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            file << "  \"" << results[i].name << "\": " << results[i].ms << (i + 1 < results.size() ? "," : "") << std::endl;
+        }
+        file << "}" << std::endl;
+    }
+
+    void WriteResults(std::ostream &output, const std::vector<Result> &results, float tolerance, bool passed)
+    {
+        output << "{" << std::endl
+               << "  \"tolerance\": " << tolerance << "," << std::endl
+               << "  \"passed\": " << (passed ? "true" : "false") << "," << std::endl
+               << "  \"workloads\": [" << std::endl;
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const Result &r = results[i];
+            output << "    {\"name\": \"" << r.name << "\", \"ms\": " << r.ms << ", \"baseline_ms\": ";
+            if (r.baseline_ms < 0)
+            {
+                output << "null";
+            }
+            else
+            {
+                output << r.baseline_ms;
+            }
+            output << ", \"passed\": " << (r.passed ? "true" : "false") << "}" << (i + 1 < results.size() ? "," : "") << std::endl;
+        }
+        output << "  ]" << std::endl
+               << "}" << std::endl;
+    }
+
+    // Fastest of a few trials in milliseconds
+    double Time(const std::function<void()> &workload)
+    {
+        double best = 0;
+        for (int i = 0; i < trials; i++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            workload();
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            best = i == 0 ? ms : std::min(best, ms);
+        }
+        return best;
+    }
+
+    BodyRecord MakeBody(char type, b2Vec2 position, float gravity_scale)
+    {
+        BodyRecord record;
+        std::memset(static_cast<void *>(&record), 0, sizeof record);
+        record.type = type;
+        record.body_type = b2_dynamicBody;
+        record.position = position;
+        record.gravity_scale = gravity_scale;
+        record.linear_damping = 0.5f;
+        record.density = 1;
+        return record;
+    }
+
+    BodyRecord MakeBox(char type, b2Vec2 position, float half_width, float half_height)
+    {
+        BodyRecord record = MakeBody(type, position, 1);
+        b2PolygonShape box;
+        box.SetAsBox(half_width, half_height);
+        record.shape_type = b2Shape::Type::e_polygon;
+        record.center = box.m_centroid;
+        record.radius = box.m_radius;
+        record.vertex_count = box.m_count;
+        for (int i = 0; i < box.m_count; i++)
+        {
+            record.vertices[i] = box.m_vertices[i];
+            record.normals[i] = box.m_normals[i];
+        }
+        record.friction = 0.1f;
+        return record;
+    }
+
+    BodyRecord MakeCircle(char type, b2Vec2 position, float radius, float gravity_scale)
+    {
+        BodyRecord record = MakeBody(type, position, gravity_scale);
+        record.shape_type = b2Shape::Type::e_circle;
+        record.radius = radius;
+        record.angular_damping = 0.3f;
+        record.friction = 1;
+        record.restitution = 0.4f;
+        return record;
+    }
+
+    // Towers of two posts and a plank per floor with a pig on every floor,
+    // bigger than any shipped level so the slow paths show up
+    LevelAsset GenerateTowers(int towers, int floors)
+    {
+        LevelAsset asset;
+        asset.name = "Generated";
+        asset.birds = "BBB";
+        BodyRecord ground = MakeBox('G', b2Vec2(0, 0), 50, 1);
+        ground.body_type = b2_staticBody;
+        ground.friction = 0.2f;
+        asset.bodies.push_back(ground);
+        asset.bodies.push_back(MakeCircle('B', bird_starting_position, 0.3f, 0));
+        for (int t = 0; t < towers; t++)
+        {
+            float x = 12.0f + t * 3.0f;
+            for (int f = 0; f < floors; f++)
+            {
+                float base = 1.0f + f * 2.5f;
+                asset.bodies.push_back(MakeBox('W', b2Vec2(x - 1, base + 1), 0.25f, 1));
+                asset.bodies.push_back(MakeBox('W', b2Vec2(x + 1, base + 1), 0.25f, 1));
+                asset.bodies.push_back(MakeBox('W', b2Vec2(x, base + 2.25f), 1.25f, 0.25f));
+                asset.bodies.push_back(MakeCircle('P', b2Vec2(x, base + 0.3f), 0.3f, 1));
+                asset.pig_count++;
+            }
+        }
+        asset.star_thresholds[0] = 1000;
+        asset.star_thresholds[1] = 2000;
+        asset.star_thresholds[2] = 3000;
+        return asset;
+    }
+
+    void RunWorkloads(const std::string &name, const std::string &text, const LevelAsset &asset, std::vector<Result> &results)
+    {
+        auto add = [&](const std::string &workload, double ms)
+        {
+            results.push_back({workload + "/" + name, ms, -1, true});
+        };
+
+        if (!text.empty())
+        {
+            add("parse", Time([&text]()
+                              {
+                                  for (int i = 0; i < 200; i++)
+                                  {
+                                      std::stringstream input(text);
+                                      std::vector<std::string> errors;
+                                      level_asset::Parse(input, errors);
+                                  } }));
+        }
+
+        add("settle", Time([&asset]()
+                           {
+                               Level level(asset);
+                               level.ThrowBird(0, Level::ThrowImpulse(20, 80));
+                               level.Advance(3000); }));
+
+        // The same throw with the islands stepped in parallel, to compare the backends
+        add("settle_islands", Time([&asset]()
+                                   {
+                                       Level level(asset, PhysicsBackend::Islands);
+                                       level.ThrowBird(0, Level::ThrowImpulse(20, 80));
+                                       level.Advance(3000); }));
+
+        // Contact damage on a level that has come to rest, without stepping the world
+        Level resting(asset);
+        for (int step = 0; step < 120; step++)
+        {
+            resting.Step();
+        }
+        add("damage", Time([&resting]()
+                           {
+                               for (int i = 0; i < 1000; i++)
+                               {
+                                   resting.Update();
+                               } }));
+
+        // The sprites and quads Level::Draw batches, without a window to draw them to
+        add("draw_prep", Time([&resting]()
+                              {
+                                  for (int i = 0; i < 1000; i++)
+                                  {
+                                      resting.PrepareBatches();
+                                  } }));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 2;
+    }
+    Resources::Get().SetMuted(true);
+
+    std::vector<Result> results;
+    for (const auto &path : utils::ListFiles("resources/levels", "." + file_suffix))
+    {
+        std::ifstream file(path);
+        std::stringstream text;
+        text << file.rdbuf();
+        std::vector<std::string> errors;
+        std::stringstream input(text.str());
+        LevelAsset asset = level_asset::Parse(input, errors);
+        std::string name = path.substr(path.find_last_of('/') + 1);
+        RunWorkloads(name.substr(0, name.find('.')), text.str(), asset, results);
+    }
+    if (results.empty())
+    {
+        std::cerr << "No levels found, run the tests from the project root" << std::endl;
+    }
+    RunWorkloads("generated_small", "", GenerateTowers(4, 3), results);
+    RunWorkloads("generated_large", "", GenerateTowers(12, 6), results);
+
+    if (options.update_baseline)
+    {
+        WriteBaseline(options.baseline, results);
+        std::cout << "Wrote " << results.size() << " timings to " << options.baseline << std::endl;
+        return 0;
+    }
+
+    // Without a baseline there is nothing to compare against, which is reported as a skip rather than a pass
+    std::map<std::string, double> baseline;
+    bool compare = !options.baseline.empty();
+    if (compare)
+    {
+        baseline = ReadBaseline(options.baseline);
+        if (baseline.empty())
+        {
+            std::cout << "No baseline in " << options.baseline << ", record one with --update-baseline" << std::endl;
+            compare = false;
+        }
+    }
+
+    bool passed = true;
+    for (auto &result : results)
+    {
+        auto it = baseline.find(result.name);
+        if (it != baseline.end())
+        {
+            result.baseline_ms = it->second;
+            result.passed = result.ms <= it->second * (1 + options.tolerance);
+        }
+        else if (compare)
+        {
+            // A new workload or level has to be added to the baseline before it counts
+            result.passed = false;
+        }
+        passed = passed && result.passed;
+        std::cout << (result.passed ? "ok   " : result.baseline_ms >= 0 ? "SLOW " : "NEW  ") << result.name << ": " << result.ms << " ms";
+        if (result.baseline_ms >= 0)
+        {
+            std::cout << " (baseline " << result.baseline_ms << " ms)";
+        }
+        else if (compare)
+        {
+            std::cout << " (not in the baseline, record it again with --update-baseline)";
+        }
+        std::cout << std::endl;
+    }
+
+    if (!options.output.empty())
+    {
+        std::ofstream output(options.output);
+        WriteResults(output, results, options.tolerance, passed);
+    }
+    else
+    {
+        WriteResults(std::cout, results, options.tolerance, passed);
+    }
+    if (!options.baseline.empty() && !compare)
+    {
+        return skipped;
+    }
+    return passed ? 0 : 1;
+}
@@ -1,5 +1,21 @@
 #include "../src/utils.hpp"
 #include "../src/converters.hpp"
+#include "../src/level.hpp"
+#include "../src/pig.hpp"
+#include "../src/wall.hpp"
+#include "../src/ground.hpp"
+#include "../src/particles.hpp"
+#include "../src/memory_stats.hpp"
+#include "../src/rewind.hpp"
+#include "../src/island_world.hpp"
+#include "../src/task_pool.hpp"
+#include "../src/telemetry.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <set>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 const float EPSILON = 0.0001f;
 inline bool Equal(float a, float b)
@@ -8,7 +24,26 @@ inline bool Equal(float a, float b)
     return std::abs(a - b) <= EPSILON;
 }
 
-void TestPolygonWidthCalculator()
+// Parses the level 1 fixture. CTest runs the tests from the project root, so a missing or broken file fails the test.
+bool LoadLevel1(LevelAsset &asset)
+{
+    const std::string filename = "resources/levels/level1.ab";
+    std::ifstream file(filename);
+    if (!file)
+    {
+        std::cerr << "Missing " << filename << ", run the tests from the project root" << std::endl;
+        return false;
+    }
+    std::vector<std::string> errors;
+    asset = level_asset::Parse(file, errors);
+    for (const std::string &error : errors)
+    {
+        std::cerr << filename << ": " << error << std::endl;
+    }
+    return errors.empty();
+}
+
+bool TestPolygonWidthCalculator()
 {
     std::cout << "DimensionsFromPolygon should get the dimensions from b2PolygonShape" << std::endl;
     const float WIDTH = 6.0f;
@@ -18,33 +53,33 @@ void TestPolygonWidthCalculator()
 
     b2Vec2 dimensions = utils::DimensionsFromPolygon(polygon);
 
+    delete polygon;
+
     if (dimensions.x == WIDTH && dimensions.y == HEIGHT)
     {
         std::cout << "DimensionsFromPolygon works as expected" << std::endl;
+        return true;
     }
-    else
-    {
-        std::cerr << "DimensionsFromPolygon not working." << std::endl;
-        std::cerr << "Expected width: " << WIDTH << ", got: " << dimensions.x << std::endl;
-        std::cerr << "Expected height: " << HEIGHT << ", got: " << dimensions.y << std::endl;
-    }
+    std::cerr << "DimensionsFromPolygon not working." << std::endl;
+    std::cerr << "Expected width: " << WIDTH << ", got: " << dimensions.x << std::endl;
+    std::cerr << "Expected height: " << HEIGHT << ", got: " << dimensions.y << std::endl;
+    return false;
 }
 
-void TestOpenFileSafe()
+bool TestOpenFileSafe()
 {
     std::cout << "OpenFileSafe should always return a file where writing is possible" << std::endl;
     std::ofstream output = utils::OpenFileSafe("testi");
     if (output.good())
     {
         std::cout << "OpenFileSafe works as expected" << std::endl;
+        return true;
     }
-    else
-    {
-        std::cerr << "OpenFileSafe couldn't open a file" << std::endl;
-    }
+    std::cerr << "OpenFileSafe couldn't open a file" << std::endl;
+    return false;
 }
 
-void TestConverters()
+bool TestConverters()
 {
     bool failed = false;
     std::cout << "RadiansToDegrees should convert angle correctly" << std::endl;
@@ -73,6 +108,7 @@ void TestConverters()
     {
         std::cout << "RadiansToDegrees works correctly" << std::endl;
     }
+    bool passed = !failed;
     failed = false;
 
     std::cout << "DegreesToRadians should convert angle correctly" << std::endl;
@@ -101,13 +137,638 @@ void TestConverters()
     {
         std::cout << "DegreesToRadians works correctly" << std::endl;
     }
+    return passed && !failed;
+}
+
+// Resident set size of this process in bytes, 0 if it can't be read
+long ResidentBytes()
+{
+#ifdef _WIN32
+    return 0;
+#else
+    std::ifstream statm("/proc/self/statm");
+    long total_pages, resident_pages;
+    if (!(statm >> total_pages >> resident_pages))
+    {
+        return 0;
+    }
+    return resident_pages * sysconf(_SC_PAGESIZE);
+#endif
+}
+
+bool TestLevelReloadMemory()
+{
+    const int warmup_iterations = 50;
+    const int soak_iterations = 2000;
+    const long allowed_growth = 8 * 1024 * 1024;
+    std::cout << "Reloading and retrying levels shouldn't grow memory usage" << std::endl;
+
+    bool failed = false;
+    for (int n = 1; n <= 3; n++)
+    {
+        std::string filename = "resources/levels/level" + std::to_string(n) + ".ab";
+        if (utils::FileSize(filename) < 0)
+        {
+            std::cerr << "Missing " << filename << ", run the tests from the project root" << std::endl;
+            failed = true;
+            continue;
+        }
+
+        // Same pattern as Game::LoadLevel followed by a throw that settles and the next bird put on the slingshot
+        Level level;
+        auto retry = [&level, &filename]()
+        {
+            std::ifstream file(filename);
+            level = Level(file);
+            level.ThrowBird(0, Level::ThrowImpulse(30, 90));
+            level.Advance(240);
+            level.ResetBird();
+            level.Step();
+        };
+
+        for (int i = 0; i < warmup_iterations; i++)
+        {
+            retry();
+        }
+        long before = ResidentBytes();
+        for (int i = 0; i < soak_iterations; i++)
+        {
+            retry();
+        }
+        long growth = ResidentBytes() - before;
+
+        if (growth > allowed_growth)
+        {
+            std::cerr << filename << " grew memory usage by " << growth << " bytes in " << soak_iterations << " reloads" << std::endl;
+            failed = true;
+        }
+    }
+
+    if (failed)
+    {
+        std::cerr << "Level reloading leaks memory" << std::endl;
+    }
+    else
+    {
+        std::cout << "Level reloading doesn't leak memory" << std::endl;
+    }
+    return !failed;
+}
+
+bool TestObjectFootprint()
+{
+    const size_t max_object_bytes = 64;
+    std::cout << "Game objects should only hold references to shared resources" << std::endl;
+    size_t sizes[] = {sizeof(Wall), sizeof(Pig), sizeof(Ground), sizeof(BoomerangBird), sizeof(DroppingBird), sizeof(SpeedBird)};
+    const char *names[] = {"Wall", "Pig", "Ground", "BoomerangBird", "DroppingBird", "SpeedBird"};
+
+    bool failed = false;
+    for (int i = 0; i < 6; i++)
+    {
+        std::cout << names[i] << ": " << sizes[i] << " bytes per object" << std::endl;
+        if (sizes[i] > max_object_bytes)
+        {
+            std::cerr << names[i] << " is larger than " << max_object_bytes << " bytes" << std::endl;
+            failed = true;
+        }
+    }
+    return !failed;
+}
+
+bool TestSnapshotRoundTrip()
+{
+    std::cout << "A level snapshot written as text should parse back to the same level" << std::endl;
+    LevelAsset asset;
+    if (!LoadLevel1(asset))
+    {
+        return false;
+    }
+
+    Level level(asset);
+    // Throw a bird so there is a score, and damage a wall by hand in case the throw missed
+    level.ThrowBird(0, Level::ThrowImpulse(30, 90));
+    level.Advance(240);
+    for (auto object : level.objects())
+    {
+        if (object->GetType() == 'W')
+        {
+            object->SetDThreshold(object->GetDThreshold() - 50);
+            break;
+        }
+    }
+    LevelAsset snapshot = level.Snapshot();
+
+    std::stringstream text;
+    level_asset::WriteText(text, snapshot);
+    std::vector<std::string> errors;
+    LevelAsset parsed = level_asset::Parse(text, errors);
+
+    auto total_damage = [](const LevelAsset &asset)
+    {
+        float damage = 0;
+        for (const auto &record : asset.bodies)
+        {
+            damage += record.damage;
+        }
+        return damage;
+    };
+    bool same = errors.empty() && parsed.name == snapshot.name && parsed.birds == snapshot.birds &&
+                parsed.bodies.size() == snapshot.bodies.size() && parsed.pig_count == snapshot.pig_count &&
+                parsed.score == level.GetScore() && total_damage(snapshot) >= 50;
+    for (size_t i = 0; same && i < parsed.bodies.size(); i++)
+    {
+        same = parsed.bodies[i].type == snapshot.bodies[i].type &&
+               Equal(parsed.bodies[i].position.x, snapshot.bodies[i].position.x) &&
+               Equal(parsed.bodies[i].position.y, snapshot.bodies[i].position.y) &&
+               Equal(parsed.bodies[i].damage, snapshot.bodies[i].damage);
+    }
+
+    // Resuming from the save keeps the score and the damage, including that of unloaded bodies
+    Level resumed(parsed);
+    LevelAsset resumed_snapshot = resumed.Snapshot();
+    same = same && resumed.GetScore() == level.GetScore() &&
+           std::abs(total_damage(resumed_snapshot) - total_damage(snapshot)) < 0.01f;
+    std::cout << (same ? "Snapshot round trip works as expected" : "Snapshot round trip failed") << std::endl;
+    return same;
+}
+
+bool TestParticleCap()
+{
+    std::cout << "Particle pool should never grow past its capacity" << std::endl;
+    ParticleSystem particles(256);
+    size_t peak = 0;
+    // A whole tower collapsing at once
+    for (int i = 0; i < 1000; i++)
+    {
+        particles.Emit(sf::FloatRect(0, 0, 100, 20), sf::Color::White, 48);
+        peak = std::max(peak, particles.GetCount());
+    }
+    for (int step = 0; step < 2 * framerate; step++)
+    {
+        particles.Update(time_step);
+    }
+
+    bool passed = peak <= particles.GetCapacity() && particles.GetCount() == 0;
+    std::cout << "Peak " << peak << " of " << particles.GetCapacity() << " particles, "
+              << particles.GetCount() << " left after two seconds" << std::endl;
+    return passed;
+}
+
+bool TestMemoryAccounting()
+{
+    std::cout << "Objects and Box2D memory of a level should be released with the level" << std::endl;
+    LevelAsset asset;
+    if (!LoadLevel1(asset))
+    {
+        return false;
+    }
+
+    memory_stats::Snapshot before = memory_stats::Take();
+    long long objects = 0;
+    long long box2d = 0;
+    {
+        Level level(asset);
+        level.Step();
+        objects = memory_stats::Current(MemoryTag::Objects) - before.bytes[static_cast<int>(MemoryTag::Objects)];
+        box2d = memory_stats::Current(MemoryTag::Box2D) - before.bytes[static_cast<int>(MemoryTag::Box2D)];
+    }
+    memory_stats::PrintDelta(std::cout, "destroying the level", before);
+
+    bool counted = objects > 0 && box2d > 0;
+    bool released = memory_stats::Current(MemoryTag::Objects) == before.bytes[static_cast<int>(MemoryTag::Objects)] &&
+                    memory_stats::Current(MemoryTag::Box2D) == before.bytes[static_cast<int>(MemoryTag::Box2D)];
+    std::cout << "Level 1 used " << objects << " bytes of objects and " << box2d << " bytes of Box2D memory" << std::endl;
+    return counted && released;
+}
+
+bool TestChunkStreaming()
+{
+    std::cout << "Far chunks of a wide level should only be in the world while they are in view" << std::endl;
+    LevelAsset asset;
+    if (!LoadLevel1(asset))
+    {
+        return false;
+    }
+
+    // Level 1 and a copy of its towers 200 m to the right
+    size_t far_bodies = 0;
+    for (size_t i = 0, count = asset.bodies.size(); i < count; i++)
+    {
+        if (level_asset::ChunkOf(asset.bodies[i]) != resident_chunk)
+        {
+            BodyRecord copy = asset.bodies[i];
+            copy.position.x += 200;
+            asset.bodies.push_back(copy);
+            asset.pig_count += copy.type == 'P';
+            far_bodies++;
+        }
+    }
+    level_asset::SortIntoChunks(asset);
+    int total_bodies = static_cast<int>(asset.bodies.size());
+
+    Level level(asset);
+    LevelState start = level.CaptureState();
+    bool passed = level.CountDormantBodies() == far_bodies && level.CountPigs() == asset.pig_count &&
+                  level.GetWorld()->GetBodyCount() == total_bodies - static_cast<int>(far_bodies);
+
+    level.SetFocus(195, 215);
+    for (int step = 0; step < 20; step++)
+    {
+        level.Step();
+    }
+    bool far_loaded = false;
+    level.GetWorld()->ForEachBody([&far_loaded](b2Body *body)
+                                  { far_loaded = far_loaded || body->GetPosition().x > 190; });
+    passed = passed && far_loaded && level.CountPigs() == asset.pig_count &&
+             level.GetWorld()->GetBodyCount() + static_cast<int>(level.CountDormantBodies()) == total_bodies &&
+             static_cast<int>(level.Snapshot().bodies.size()) == total_bodies;
+
+    // Restoring the starting state with the view back at the slingshot unloads the far towers again
+    level.SetFocus(0, 20);
+    level.RestoreState(start);
+    passed = passed && level.CountDormantBodies() == far_bodies &&
+             level.GetWorld()->GetBodyCount() == total_bodies - static_cast<int>(far_bodies);
+
+    std::cout << (passed ? "Chunk streaming works as expected" : "Chunk streaming failed") << std::endl;
+    return passed;
+}
+
+bool TestChunkSupport()
+{
+    std::cout << "A chunk should stay loaded while bodies of a loaded chunk stand on it" << std::endl;
+    LevelAsset asset;
+    if (!LoadLevel1(asset))
+    {
+        return false;
+    }
+
+    // A static platform at the start of the third chunk and a wall in the second chunk standing on it
+    BodyRecord platform = *std::find_if(asset.bodies.begin(), asset.bodies.end(), [](const BodyRecord &record)
+                                        { return record.type == 'W'; });
+    BodyRecord wall = platform;
+    platform.body_type = b2_staticBody;
+    platform.position.Set(2 * chunk_width + 0.5f, 5);
+    wall.position.Set(2 * chunk_width - 0.1f, 7.015f);
+    asset.bodies.push_back(platform);
+    asset.bodies.push_back(wall);
+    level_asset::SortIntoChunks(asset);
+    Level level(asset);
+
+    // Loading the platform only touches the static layer around it
+    level.SetFocus(40, 60);
+    for (int step = 0; step < 240; step++)
+    {
+        level.Step();
+    }
+    sf::FloatRect updated;
+    bool passed = level.TakeStaticUpdate(updated) && updated.contains(platform.position.x * scale, updated.top + 1) &&
+                  updated.width < chunk_width * scale;
+
+    // Back at the slingshot the platform's chunk could be unloaded, but the wall is still loaded and stands on it
+    level.SetFocus(0, 16);
+    for (int step = 0; step < 240; step++)
+    {
+        level.Step();
+    }
+    bool platform_loaded = false;
+    float wall_height = 0;
+    level.GetWorld()->ForEachBody([&](b2Body *body)
+                                  {
+                                      platform_loaded = platform_loaded || (body->GetType() == b2_staticBody && body->GetPosition().x > 2 * chunk_width);
+                                      if (body->GetType() != b2_staticBody && std::abs(body->GetPosition().x - wall.position.x) < 0.5f)
+                                      {
+                                          wall_height = body->GetPosition().y;
+                                      } });
+    passed = passed && platform_loaded && wall_height > 6.5f;
+
+    std::cout << (passed ? "Chunk support works as expected" : "Chunk support failed") << std::endl;
+    return passed;
+}
+
+bool TestOutOfBoundsCulling()
+{
+    std::cout << "Bodies outside the play area should be removed from the world and score as destroyed" << std::endl;
+    LevelAsset asset;
+    if (!LoadLevel1(asset))
+    {
+        return false;
+    }
+
+    Level level(asset);
+    // A play area nothing is inside of, only the static ground and the bird's body may stay
+    b2AABB bounds;
+    bounds.lowerBound.Set(1000, 1000);
+    bounds.upperBound.Set(1001, 1001);
+    level.SetBounds(bounds);
+    int pigs = level.CountPigs();
+    level.Step();
+
+    bool passed = level.CountPigs() == 0 && level.GetScore() > 0 && level.GetWorld()->GetBodyCount() == 2 &&
+                  !level.GetBird()->GetBody()->IsEnabled() && level.IsLevelEnded();
+    std::cout << "Culled " << level.GetCulledCount() << " bodies with " << pigs << " pigs, score " << level.GetScore() << std::endl;
+    level.ResetBird();
+    passed = passed && level.GetBird()->GetBody()->IsEnabled();
+    std::cout << (passed ? "Out of bounds culling works as expected" : "Out of bounds culling failed") << std::endl;
+    return passed;
+}
+
+bool SameLevelState(const LevelState &a, const LevelState &b)
+{
+    if (a.bodies.size() != b.bodies.size() || a.birds != b.birds || a.score != b.score || a.bird_thrown != b.bird_thrown ||
+        a.bird_power_used != b.bird_power_used || a.level_ended != b.level_ended)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < a.bodies.size(); i++)
+    {
+        const BodyState &x = a.bodies[i], &y = b.bodies[i];
+        if (x.id != y.id || !Equal(x.position.x, y.position.x) || !Equal(x.position.y, y.position.y) || !Equal(x.angle, y.angle) ||
+            !Equal(x.health, y.health))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TestRewind()
+{
+    std::cout << "Rewinding should decode the stored states exactly and put the level back into them" << std::endl;
+    LevelAsset asset;
+    if (!LoadLevel1(asset))
+    {
+        return false;
+    }
+
+    Level level(asset);
+    level.ThrowBird(0, Level::ThrowImpulse(20, 80));
+    // A small keyframe interval so most of the states are deltas
+    RewindBuffer buffer(4 * 1024 * 1024, 10, 4);
+    std::vector<LevelState> pushed;
+    for (int i = 0; i < 12; i++)
+    {
+        level.Advance(10);
+        pushed.push_back(level.CaptureState());
+        buffer.Push(pushed.back());
+    }
+
+    bool passed = buffer.GetCount() == pushed.size() && memory_stats::Current(MemoryTag::Rewind) >= static_cast<long long>(buffer.GetBytes());
+    for (size_t i = 0; passed && i < pushed.size(); i++)
+    {
+        LevelState decoded;
+        passed = buffer.Get(i, decoded) && SameLevelState(decoded, pushed[i]);
+    }
+
+    // Level 1 has the same static bodies in every state, so the baked layer stays valid
+    unsigned static_changes = level.GetStaticChanges();
+    passed = passed && buffer.Restore(level, 5) && buffer.GetCount() == 6 && SameLevelState(level.CaptureState(), pushed[5]) &&
+             level.GetStaticChanges() == static_changes;
+    // Play goes on from the restored state
+    level.Advance(10);
+    passed = passed && level.GetBird()->IsThrown();
+
+    // A budget too small for more than a few states keeps only the newest ones
+    RewindBuffer small(3 * buffer.GetBytes() / buffer.GetCount(), 10, 4);
+    for (const auto &state : pushed)
+    {
+        small.Push(state);
+    }
+    LevelState newest;
+    passed = passed && small.GetCount() > 0 && small.GetCount() < pushed.size() && small.Get(small.GetCount() - 1, newest) &&
+             SameLevelState(newest, pushed.back());
+
+    std::cout << (passed ? "Rewind works as expected" : "Rewind failed") << std::endl;
+    return passed;
+}
+
+// Ground with stacks of boxes on it, every body numbered in its user data
+void BuildStacks(PhysicsWorld &world, int stacks, int height)
+{
+    b2BodyDef ground_def;
+    b2Body *ground = world.CreateBody(ground_def);
+    b2PolygonShape ground_shape;
+    ground_shape.SetAsBox(100, 1);
+    ground->CreateFixture(&ground_shape, 0);
+
+    b2PolygonShape box;
+    box.SetAsBox(0.5f, 0.5f);
+    uintptr_t number = 0;
+    for (int s = 0; s < stacks; s++)
+    {
+        for (int h = 0; h < height; h++)
+        {
+            b2BodyDef def;
+            def.type = b2_dynamicBody;
+            def.position.Set(5.0f + 8.0f * s, 1.5f + h);
+            def.userData.pointer = ++number;
+            world.CreateBody(def)->CreateFixture(&box, 1);
+        }
+    }
+}
+
+bool TestIslandWorld()
+{
+    std::cout << "The island backend should spread independent stacks over its shards and simulate them like Box2D" << std::endl;
+    Box2DWorld reference(gravity);
+    IslandWorld islands(gravity, 4);
+    BuildStacks(reference, 6, 10);
+    BuildStacks(islands, 6, 10);
+    int moved = 0;
+    for (int step = 0; step < 120; step++)
+    {
+        reference.Step(time_step, velocity_iterations, position_iterations);
+        islands.Step(time_step, velocity_iterations, position_iterations);
+        moved += static_cast<int>(islands.GetMovedBodies().size());
+    }
+
+    std::map<uintptr_t, b2Vec2> positions;
+    reference.ForEachBody([&positions](b2Body *body)
+                          { positions[body->GetUserData().pointer] = body->GetPosition(); });
+    float max_difference = 0;
+    islands.ForEachBody([&positions, &max_difference](b2Body *body)
+                        { max_difference = std::max(max_difference, (body->GetPosition() - positions[body->GetUserData().pointer]).Length()); });
+    int used_shards = 0;
+    for (int i = 0; i < islands.GetShardCount(); i++)
+    {
+        used_shards += islands.CountShardBodies(i) > 0;
+    }
+    int contacts = 0;
+    islands.ForEachContact([&contacts](b2Contact *contact)
+                           { contacts += contact->IsTouching(); });
+
+    bool passed = islands.GetBodyCount() == reference.GetBodyCount() && used_shards > 1 && moved > 0 && contacts > 0 &&
+                  max_difference < 0.05f;
+    std::cout << "Moved " << moved << " bodies into " << used_shards << " shards, largest difference " << max_difference << " m" << std::endl;
+    std::cout << (passed ? "Island backend works as expected" : "Island backend failed") << std::endl;
+    return passed;
+}
+
+bool TestMergeAndRebalance()
+{
+    std::cout << "A body merged and rebalanced in the same step should be reported once, as its newest body" << std::endl;
+    IslandWorld islands(gravity, 4);
+    BuildStacks(islands, 6, 10);
+    // The first step spreads the stacks over the shards and the next rebalance comes 60 steps later
+    for (int step = 0; step < 60; step++)
+    {
+        islands.Step(time_step, velocity_iterations, position_iterations);
+    }
+
+    // Shoot the top box of the second stack at the first one, which is in another shard. Both shards
+    // are merged at the start of the next step and the rebalance at its end moves a stack out again.
+    islands.ForEachBody([](b2Body *body)
+                        {
+                            if (body->GetUserData().pointer == 20)
+                            {
+                                body->SetLinearVelocity(b2Vec2(-600, 0));
+                            } });
+    int bodies = islands.GetBodyCount();
+    islands.Step(time_step, velocity_iterations, position_iterations);
+
+    std::set<b2Body *> alive;
+    islands.ForEachBody([&alive](b2Body *body)
+                        { alive.insert(body); });
+    const std::vector<BodyMove> &moved = islands.GetMovedBodies();
+    bool passed = !moved.empty() && islands.GetBodyCount() == bodies;
+    for (const auto &move : moved)
+    {
+        // Followed like Level::FollowMovedBodies does, which reads a destroyed body if one is reported.
+        // AddressSanitizer stops there, otherwise the pointer checks below fail.
+        passed = passed && move.to->GetUserData().pointer != 0;
+        passed = passed && alive.count(move.to) == 1 && alive.count(move.from) == 0;
+        for (const auto &other : moved)
+        {
+            passed = passed && other.from != move.to;
+        }
+    }
+    std::cout << "Moved " << moved.size() << " bodies" << std::endl;
+    std::cout << (passed ? "Merge and rebalance work as expected" : "Merge and rebalance failed") << std::endl;
+    return passed;
+}
+
+bool TestBirdAcrossShards()
+{
+    std::cout << "A bird moved into another shard of the island backend should use its power on its new body" << std::endl;
+    LevelAsset asset;
+    if (!LoadLevel1(asset))
+    {
+        return false;
+    }
+    if (TaskPool::Get().GetThreadCount() < 2)
+    {
+        std::cout << "Skipping, the island backend has a single shard on this machine" << std::endl;
+        return true;
+    }
+
+    // Level 1 with six columns of ten walls next to its tower, enough bodies for the island
+    // backend to spread them out. The bird is the smallest island so it leaves the first shard.
+    BodyRecord wall = *std::find_if(asset.bodies.begin(), asset.bodies.end(), [](const BodyRecord &record)
+                                    { return record.type == 'W'; });
+    for (int column = 0; column < 6; column++)
+    {
+        for (int row = 0; row < 10; row++)
+        {
+            BodyRecord copy = wall;
+            copy.position.Set(16 + 2.5f * column, wall.position.y + 2.03f * row);
+            asset.bodies.push_back(copy);
+        }
+    }
+    level_asset::SortIntoChunks(asset);
+    Level level(asset, PhysicsBackend::Islands);
+
+    b2Body *first_body = level.GetBird()->GetBody();
+    level.Step();
+    bool moved = level.GetBird()->GetBody() != first_body;
+
+    // The old body has been destroyed, a power used now must reach the new one
+    level.ThrowBird(0, Level::ThrowImpulse(30, 90));
+    level.GetBird()->NewPower();
+    level.GetBird()->UsePower();
+    bool powered = level.GetBird()->GetBody()->GetAngularVelocity() == 40;
+    for (int step = 0; step < 120; step++)
+    {
+        level.Step();
+    }
+    bool in_world = false;
+    level.GetWorld()->ForEachBody([&level, &in_world](b2Body *body)
+                                  { in_world = in_world || body == level.GetBird()->GetBody(); });
+
+    bool passed = moved && powered && in_world;
+    std::cout << (passed ? "Bird powers across shards work as expected" : "Bird powers across shards failed") << std::endl;
+    return passed;
+}
+
+bool TestTelemetry()
+{
+    std::cout << "Telemetry should write one JSON line per attempt once the recorder is done" << std::endl;
+    std::string directory = cache_directory + "/telemetry_test";
+    utils::MakeDirectory(cache_directory);
+    utils::MakeDirectory(directory);
+    std::remove((directory + "/telemetry.txt").c_str());
+    for (int i = 0; i < 4; i++)
+    {
+        std::remove((directory + "/telemetry" + std::to_string(i) + ".jsonl").c_str());
+    }
+
+    {
+        Telemetry telemetry(directory);
+        telemetry.BeginAttempt(0xabcdef, 3);
+        telemetry.RecordThrow();
+        // 100 one millisecond steps and one slow step, the slow one only shows in the maximum
+        for (int i = 0; i < 100; i++)
+        {
+            telemetry.RecordSteps(1, sf::microseconds(990), 20 + i, 5);
+        }
+        telemetry.RecordSteps(1, sf::milliseconds(30), 10, 50);
+        telemetry.RecordSettled();
+        telemetry.EndAttempt(4200, 2, true, true);
+        // Not recording, ignored
+        telemetry.RecordThrow();
+        telemetry.EndAttempt(0, 0, false, false);
+    }
+
+    std::ifstream file(directory + "/telemetry0.jsonl");
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        lines.push_back(line);
+    }
+    auto has = [&lines](const std::string &text)
+    {
+        return !lines.empty() && lines[0].find(text) != std::string::npos;
+    };
+    bool passed = lines.size() == 1 && has("\"level_hash\":\"0000000000abcdef\"") && has("\"level\":3") && has("\"throws\":1") &&
+                  has("\"steps\":101") && has("\"p50\":1,") && has("\"max\":30") && has("\"peak_bodies\":119") &&
+                  has("\"peak_contacts\":50") && has("\"score\":4200") && has("\"cleared\":true");
+    if (!lines.empty())
+    {
+        std::cout << lines[0] << std::endl;
+    }
+    std::cout << (passed ? "Telemetry works as expected" : "Telemetry failed") << std::endl;
+    return passed;
 }
 
 int main()
 {
-    TestPolygonWidthCalculator();
-    TestOpenFileSafe();
-    TestConverters();
+    // Destruction sounds would go to the audio device otherwise
+    Resources::Get().SetMuted(true);
+    bool units_passed = TestPolygonWidthCalculator();
+    units_passed = TestOpenFileSafe() && units_passed;
+    units_passed = TestConverters() && units_passed;
+    bool footprint_passed = TestObjectFootprint();
+    bool soak_passed = TestLevelReloadMemory();
+    bool snapshot_passed = TestSnapshotRoundTrip();
+    bool particles_passed = TestParticleCap();
+    bool memory_passed = TestMemoryAccounting();
+    bool streaming_passed = TestChunkStreaming();
+    streaming_passed = TestChunkSupport() && streaming_passed;
+    bool culling_passed = TestOutOfBoundsCulling();
+    bool rewind_passed = TestRewind();
+    bool islands_passed = TestIslandWorld();
+    islands_passed = TestMergeAndRebalance() && islands_passed;
+    bool bird_shards_passed = TestBirdAcrossShards();
+    bool telemetry_passed = TestTelemetry();
 
-    return 0;
+    return units_passed && footprint_passed && soak_passed && snapshot_passed && particles_passed && memory_passed && streaming_passed && culling_passed && rewind_passed && islands_passed && bird_shards_passed && telemetry_passed ? 0 : 1;
 }
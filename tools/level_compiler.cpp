@@ -0,0 +1,164 @@
+// Validates level files and compiles them into binary assets at build time.
+// Broken levels fail the build instead of being skipped when the game loads them.
+#include "../src/level_asset.hpp"
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+    void PrintUsage()
+    {
+        std::cerr << "Usage: ab_levelc --output-dir DIR --source FILE.cpp [--no-embed] level.ab..." << std::endl
+                  << "  --output-dir DIR  write <content hash>.abl binary assets to DIR" << std::endl
+                  << "  --source FILE     write a C++ file embedding the assets into the game" << std::endl
+                  << "  --no-embed        leave the embedded table empty, the game loads DIR instead" << std::endl;
+    }
+
+    std::string HashName(uint64_t hash)
+    {
+        std::stringstream name;
+        name << std::hex << std::setw(16) << std::setfill('0') << hash;
+        return name.str();
+    }
+
+    void WriteSource(std::ostream &source, const std::vector<LevelAsset> &assets, const std::vector<std::string> &blobs)
+    {
+        source << "// Generated by ab_levelc from the level files, do not edit" << std::endl
+               << "#include \"src/level_asset.hpp\"" << std::endl
+               << std::endl
+               << "namespace" << std::endl
+               << "{" << std::endl;
+        for (size_t i = 0; i < blobs.size(); i++)
+        {
+            source << "    // " << assets[i].name << std::endl
+                   << "    const unsigned char level_" << i << "[] = {";
+            for (size_t b = 0; b < blobs[i].size(); b++)
+            {
+                source << (b % 24 == 0 ? "\n        " : " ") << static_cast<int>(static_cast<unsigned char>(blobs[i][b])) << ",";
+            }
+            source << "};" << std::endl;
+        }
+        source << std::endl
+               << "    struct EmbeddedLevel" << std::endl
+               << "    {" << std::endl
+               << "        uint64_t hash;" << std::endl
+               << "        const unsigned char *data;" << std::endl
+               << "        size_t size;" << std::endl
+               << "    };" << std::endl
+               << std::endl
+               << "    const EmbeddedLevel embedded_levels[] = {" << std::endl;
+        for (size_t i = 0; i < blobs.size(); i++)
+        {
+            source << "        {0x" << HashName(assets[i].source_hash) << "ULL, level_" << i << ", sizeof level_" << i << "}," << std::endl;
+        }
+        source << "        {0, nullptr, 0}};" << std::endl
+               << "}" << std::endl
+               << std::endl
+               << "bool level_asset::FindEmbedded(uint64_t source_hash, const char *&data, size_t &size)" << std::endl
+               << "{" << std::endl
+               << "    for (const EmbeddedLevel *level = embedded_levels; level->data != nullptr; level++)" << std::endl
+               << "    {" << std::endl
+               << "        if (level->hash == source_hash)" << std::endl
+               << "        {" << std::endl
+               << "            data = reinterpret_cast<const char *>(level->data);" << std::endl
+               << "            size = level->size;" << std::endl
+               << "            return true;" << std::endl
+               << "        }" << std::endl
+               << "    }" << std::endl
+               << "    return false;" << std::endl
+               << "}" << std::endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::string output_dir, source_file;
+    bool embed = true;
+    std::vector<std::string> level_files;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--output-dir" && i + 1 < argc)
+        {
+            output_dir = argv[++i];
+        }
+        else if (arg == "--source" && i + 1 < argc)
+        {
+            source_file = argv[++i];
+        }
+        else if (arg == "--no-embed")
+        {
+            embed = false;
+        }
+        else if (arg[0] == '-')
+        {
+            PrintUsage();
+            return 1;
+        }
+        else
+        {
+            level_files.push_back(arg);
+        }
+    }
+    if (output_dir.empty() || source_file.empty())
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    bool failed = false;
+    std::vector<LevelAsset> assets;
+    std::vector<std::string> blobs;
+    for (const auto &filename : level_files)
+    {
+        std::ifstream file(filename);
+        if (!file.good())
+        {
+            std::cerr << filename << ": can't open level file" << std::endl;
+            failed = true;
+            continue;
+        }
+        std::vector<std::string> errors;
+        LevelAsset asset = level_asset::Parse(file, errors);
+        for (const auto &error : errors)
+        {
+            std::cerr << filename << ": " << error << std::endl;
+        }
+        if (!errors.empty())
+        {
+            failed = true;
+            continue;
+        }
+
+        std::stringstream blob;
+        level_asset::WriteBinary(blob, asset);
+        std::ofstream output(output_dir + "/" + HashName(asset.source_hash) + ".abl", std::ios::binary);
+        output << blob.str();
+        if (!output.good())
+        {
+            std::cerr << "Can't write compiled level to " << output_dir << std::endl;
+            failed = true;
+            continue;
+        }
+        std::cout << filename << ": " << asset.bodies.size() << " bodies, " << asset.pig_count << " pigs, "
+                  << asset.birds.size() << " birds -> " << HashName(asset.source_hash) << ".abl" << std::endl;
+        assets.push_back(asset);
+        blobs.push_back(blob.str());
+    }
+    if (failed)
+    {
+        return 1;
+    }
+
+    std::ofstream source(source_file);
+    if (embed)
+    {
+        WriteSource(source, assets, blobs);
+    }
+    else
+    {
+        WriteSource(source, {}, {});
+    }
+    return source.good() ? 0 : 1;
+}